@@ -46,7 +46,7 @@ void printStatusMethod(void) {
     if(getFocusedWindow() && isNotInInvisibleWorkspace(getFocusedWindow())) {
         if(isLogging(LOG_LEVEL_DEBUG))
             dprintf(STATUS_FD, "%0x ", getFocusedWindow()->id);
-        dprintf(STATUS_FD, "^fg(%s)%s^fg()", "green", getFocusedWindow()->title);
+        dprintf(STATUS_FD, "^fg(%s)%s^fg()", "green", getTitle(getFocusedWindow()));
     }
     else {
         dprintf(STATUS_FD, "Focused on %0xd (root: %0xd)", getActiveFocus(), root);
@@ -93,9 +93,9 @@ void addStickyPrimaryMonitorRule() {
 
 void keepTransientsOnTop(WindowInfo* winInfo) {
     WindowID id = winInfo->id;
-    FOR_EACH(WindowInfo*, winInfo2, getAllWindows()) {
-        if(winInfo2->transientFor == id)
-            raiseWindowInfo(winInfo2, id);
+    const ArrayList* transients = getTransientsOf(id);
+    FOR_EACH(WindowInfo*, winInfo2, transients) {
+        raiseWindowInfo(winInfo2, id);
     }
 }
 void addKeepTransientsOnTopRule() {
@@ -104,7 +104,7 @@ void addKeepTransientsOnTopRule() {
 void shiftWindowToPositionInWorkspaceStack(WindowInfo* winInfo, InsertWindowPosition arg) {
     ArrayList* stack = getWorkspaceWindowStack(getWorkspaceOfWindow(winInfo));
     if(winInfo->creationTime && peek(stack) == winInfo) {
-        int index = getFocusedWindow() ? getIndex(stack, getFocusedWindow(), sizeof(WindowID)) : -1;
+        int index = getFocusedWindow() ? getIndexOfPointer(stack, getFocusedWindow()) : -1;
         if(index == -1 && arg != HEAD_OF_STACK)
             return;
         switch(arg) {
@@ -169,7 +169,7 @@ static void loadSavedWorkspaceWindows() {
                 WindowInfo* winInfo = getWindowInfo(wid[i]);
                 if(winInfo && getWorkspaceIndexOfWindow(winInfo) == workspaceID) {
                     Workspace* w = getWorkspace(workspaceID);
-                    shiftToEnd(getWorkspaceWindowStack(w), getIndex(getWorkspaceWindowStack(w), winInfo, sizeof(WindowID)));
+                    shiftToEnd(getWorkspaceWindowStack(w), getIndexOfPointer(getWorkspaceWindowStack(w), winInfo));
                 }
             }
     }
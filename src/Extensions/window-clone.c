@@ -1,13 +1,18 @@
 #include <assert.h>
+#include <poll.h>
 #include <string.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
+#include <xcb/damage.h>
 
 #include "../boundfunction.h"
 #include "../util/logger.h"
+#include "../util/time.h"
 #include "../user-events.h"
 #include "../xutil/window-properties.h"
 #include "../windows.h"
 #include "../wmfunctions.h"
+#include "../xevent.h"
 #include "../xutil/xsession.h"
 #include "window-clone.h"
 
@@ -17,10 +22,21 @@ static void create_graphics_context(void) {
     uint32_t mask = XCB_GC_FOREGROUND | XCB_GC_BACKGROUND | XCB_GC_GRAPHICS_EXPOSURES;
     uint32_t values[3] = { screen->black_pixel, screen->white_pixel, 0};
     graphics_context = xcb_generate_id(dis);
-    xcb_void_cookie_t cookie = xcb_create_gc_checked(dis,
-            graphics_context, root,
-            mask, values);
-    catchError(cookie);
+    XCALL(xcb_create_gc, dis, graphics_context, root, mask, values);
+}
+
+/// response_type of XCB_DAMAGE_NOTIFY or 0 if the damage extension isn't supported
+static uint8_t damageNotifyType;
+static void initDamageExtension(void) {
+    damageNotifyType = 0;
+    const xcb_query_extension_reply_t* reply = xcb_get_extension_data(dis, &xcb_damage_id);
+    if(!reply || !reply->present) {
+        WARN("Damage extension is not supported; clones will be fully repainted");
+        return;
+    }
+    free(xcb_damage_query_version_reply(dis,
+            xcb_damage_query_version(dis, XCB_DAMAGE_MAJOR_VERSION, XCB_DAMAGE_MINOR_VERSION), NULL));
+    damageNotifyType = reply->first_event + XCB_DAMAGE_NOTIFY;
 }
 
 
@@ -35,6 +51,30 @@ typedef struct CloneInfo {
 } CloneInfo ;
 static ArrayList clones;
 
+/// Max number of disjoint rectangles tracked per window before they are merged together
+#define MAX_CLONE_DAMAGE_RECTS 8
+/// Used to estimate the number of bytes copied; assumes a 32bpp server side representation
+#define CLONE_BYTES_PER_PIXEL 4
+/// Holds the clones of a single window and the regions of it that have been drawn to since its clones were last updated
+typedef struct {
+    /// ID of the original window
+    WindowID originalID;
+    /// the CloneInfo of every clone of originalID
+    ArrayList clones;
+    /// the damage object monitoring originalID or 0 if the damage extension isn't supported
+    xcb_damage_damage_t damage;
+    /// number of valid entries in rects
+    uint8_t numRects;
+    /// the pending damaged areas relative to originalID
+    xcb_rectangle_t rects[MAX_CLONE_DAMAGE_RECTS];
+} CloneSource;
+static ArrayList cloneSources;
+static uint64_t cloneBytesCopied;
+
+uint64_t getCloneBytesCopied(void) {
+    return cloneBytesCopied;
+}
+
 
 CloneInfo* getCloneInfo(WindowInfo* winInfo) {
     FOR_EACH(CloneInfo*, clone, &clones) {
@@ -56,22 +96,134 @@ WindowInfo* getParent(WindowInfo* clone) {
 /**
  * Updates the displayed image for the cloned window
  *
- * @param cloneInfo
+ * @param info the CloneInfo of clone
+ * @param clone
+ * @param parent
  */
-static void updateClone(WindowInfo* clone, WindowInfo* parent) {
-    assert(clone);
-    CloneInfo* info = getCloneInfo(clone);
+static void copyParentIntoClone(CloneInfo* info, WindowInfo* clone, WindowInfo* parent) {
     const Rect dims = clone->geometry;
-    setWindowTitle(clone->id, parent->title);
     xcb_copy_area(dis, parent->id, clone->id, graphics_context,
         info->offset[0], info->offset[1], 0, 0, dims.width, dims.height);
+    cloneBytesCopied += (uint64_t)dims.width * dims.height * CLONE_BYTES_PER_PIXEL;
+}
+static void updateClone(WindowInfo* clone, WindowInfo* parent) {
+    assert(clone);
+    copyParentIntoClone(getCloneInfo(clone), clone, parent);
+}
+
+/**
+ * Copies a single damaged area of the original window into the clone
+ *
+ * @param info
+ * @param dims the size of the clone
+ * @param area the damaged area relative to the original window
+ */
+static void copyDamagedArea(CloneInfo* info, Rect dims, xcb_rectangle_t area) {
+    int x = MAX(area.x, info->offset[0]);
+    int y = MAX(area.y, info->offset[1]);
+    int width = MIN(area.x + area.width, info->offset[0] + dims.width) - x;
+    int height = MIN(area.y + area.height, info->offset[1] + dims.height) - y;
+    if(width <= 0 || height <= 0)
+        return;
+    xcb_copy_area(dis, info->originalID, info->cloneID, graphics_context,
+        x, y, x - info->offset[0], y - info->offset[1], width, height);
+    cloneBytesCopied += (uint64_t)width * height * CLONE_BYTES_PER_PIXEL;
+}
+
+static CloneSource* getCloneSource(WindowID original) {
+    return findElement(&cloneSources, &original, sizeof(WindowID));
+}
+static CloneSource* getOrCreateCloneSource(WindowInfo* parent) {
+    CloneSource* source = getCloneSource(parent->id);
+    if(source)
+        return source;
+    source = calloc(sizeof(CloneSource), 1);
+    source->originalID = parent->id;
+    if(damageNotifyType) {
+        source->damage = xcb_generate_id(dis);
+        xcb_damage_create(dis, source->damage, parent->id, XCB_DAMAGE_REPORT_LEVEL_DELTA_RECTANGLES);
+    }
+    addElement(&cloneSources, source);
+    return source;
+}
+/**
+ * @param parent
+ * @return the CloneInfo of every clone of parent
+ */
+static ArrayList* getClonesOf(WindowInfo* parent) {
+    static ArrayList noClones;
+    CloneSource* source = getCloneSource(parent->id);
+    return source ? &source->clones : &noClones;
+}
+
+static bool isAdjacentOrOverlapping(xcb_rectangle_t a, xcb_rectangle_t b) {
+    return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+static xcb_rectangle_t getBoundingBox(xcb_rectangle_t a, xcb_rectangle_t b) {
+    int x = MIN(a.x, b.x);
+    int y = MIN(a.y, b.y);
+    return (xcb_rectangle_t) {x, y, MAX(a.x + a.width, b.x + b.width) - x, MAX(a.y + a.height, b.y + b.height) - y};
+}
+/**
+ * Adds area to the pending damage of source.
+ * Rectangles that touch are merged and if there are too many disjoint rectangles, all of them are merged into one
+ *
+ * @param source
+ * @param area
+ */
+static void addDamagedArea(CloneSource* source, xcb_rectangle_t area) {
+    for(int i = 0; i < source->numRects; i++)
+        if(isAdjacentOrOverlapping(source->rects[i], area)) {
+            source->rects[i] = getBoundingBox(source->rects[i], area);
+            return;
+        }
+    if(source->numRects == MAX_CLONE_DAMAGE_RECTS) {
+        for(int i = 1; i < source->numRects; i++)
+            area = getBoundingBox(source->rects[i], area);
+        source->rects[0] = getBoundingBox(source->rects[0], area);
+        source->numRects = 1;
+        return;
+    }
+    source->rects[source->numRects++] = area;
+}
+
+void onDamageNotify(xcb_generic_event_t* event) {
+    if(!damageNotifyType || (event->response_type & 127) != damageNotifyType)
+        return;
+    xcb_damage_notify_event_t* damageEvent = (xcb_damage_notify_event_t*)event;
+    CloneSource* source = getCloneSource(damageEvent->drawable);
+    if(source && source->damage) {
+        TRACE("Window %d damaged at %d %d %d %d", damageEvent->drawable,
+            damageEvent->area.x, damageEvent->area.y, damageEvent->area.width, damageEvent->area.height);
+        addDamagedArea(source, damageEvent->area);
+    }
+}
+
+uint32_t updateDamagedClones(void) {
+    uint32_t count = 0;
+    FOR_EACH(CloneSource*, source, &cloneSources) {
+        if(!source->numRects)
+            continue;
+        FOR_EACH(CloneInfo*, info, &source->clones) {
+            WindowInfo* clone = getWindowInfo(info->cloneID);
+            if(!clone)
+                continue;
+            for(int i = 0; i < source->numRects; i++)
+                copyDamagedArea(info, clone->geometry, source->rects[i]);
+            count++;
+        }
+        source->numRects = 0;
+        xcb_damage_subtract(dis, source->damage, XCB_NONE, XCB_NONE);
+    }
+    return count;
 }
 
 uint32_t CLONE_REFRESH_RATE = 15;
+uint32_t CLONE_REFRESH_BUDGET = 4;
 
 static void syncPropertiesWithParent(WindowID clone, WindowInfo* parent) {
-    setWindowTitle(clone, parent->title);
-    setWindowClass(clone, parent->className, parent->instanceName);
+    setWindowTitle(clone, getTitle(parent));
+    setWindowClass(clone, getClassName(parent), getInstanceName(parent));
     setWindowType(clone, parent->type);
 }
 WindowInfo* cloneWindow(WindowInfo* winInfo) {
@@ -81,7 +233,7 @@ WindowInfo* cloneWindow(WindowInfo* winInfo) {
     WindowID win = createWindow(winInfo->parent, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_CW_OVERRIDE_REDIRECT, values,
             winInfo->geometry);
     xcb_icccm_wm_hints_t hints = {.input = hasMask(winInfo, INPUT_MASK)};
-    catchError(xcb_icccm_set_wm_hints_checked(dis, win, &hints));
+    XCALL(xcb_icccm_set_wm_hints, dis, win, &hints);
     WindowInfo* clone = newWindowInfo(win, winInfo->parent);
     syncPropertiesWithParent(clone->id, winInfo);
     addMask(clone, winInfo->mask & EXTERNAL_MASKS);
@@ -95,19 +247,32 @@ WindowInfo* cloneWindow(WindowInfo* winInfo) {
     cloneInfo->originalID = winInfo->id;
     cloneInfo->cloneID = clone->id;
     addElement(&clones, cloneInfo);
-    updateClone(clone, winInfo);
+    addElement(&getOrCreateCloneSource(winInfo)->clones, cloneInfo);
+    copyParentIntoClone(cloneInfo, clone, winInfo);
     return registerWindowInfo(clone, NULL) ? clone : NULL;
 }
 void killAllClones(WindowInfo* parent) {
-    FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {
-        if(isCloneOf(winInfo, parent))
-            destroyWindow(winInfo->id);
+    ArrayList* parentClones = getClonesOf(parent);
+    FOR_EACH(CloneInfo*, info, parentClones) {
+        destroyWindow(info->cloneID);
+    }
+}
+/**
+ * Keeps the titles of the clones of parent in sync with parent
+ *
+ * @param parent
+ */
+static void syncCloneTitles(WindowInfo* parent) {
+    FOR_EACH(CloneInfo*, info, getClonesOf(parent)) {
+        setWindowTitle(info->cloneID, getTitle(parent));
     }
 }
 void updateAllClonesOfWindow(WindowInfo* parent) {
-    FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {
-        if(isCloneOf(winInfo, parent))
-            updateClone(winInfo, parent);
+    ArrayList* parentClones = getClonesOf(parent);
+    FOR_EACH(CloneInfo*, info, parentClones) {
+        WindowInfo* clone = getWindowInfo(info->cloneID);
+        if(clone)
+            copyParentIntoClone(info, clone, parent);
     }
 }
 
@@ -116,11 +281,86 @@ uint32_t updateAllClones(void) {
     FOR_EACH(CloneInfo*, info, &clones) {
         WindowInfo* clone = getWindowInfo(info->cloneID);
         WindowInfo* parent = getWindowInfo(info->originalID);
-        updateClone(clone, parent);
+        copyParentIntoClone(info, clone, parent);
         count++;
     }
     return count;
 }
+static void onIdleUpdateDamagedClones(void) {
+    updateDamagedClones();
+}
+
+/// index into clones of the next clone to be refreshed; non-zero when a refresh has been spread across multiple frames
+static uint32_t nextCloneToRefresh;
+/// when the last full refresh of all clones started
+static uint32_t lastCloneRefreshTime;
+static int cloneRefreshTimerFD = -1;
+
+static bool isCloneRefreshable(CloneInfo* info, WindowInfo** clone, WindowInfo** parent) {
+    *clone = getWindowInfo(info->cloneID);
+    *parent = getWindowInfo(info->originalID);
+    // the contents of the parent aren't available when it isn't mapped
+    return *clone && *parent && hasMask(*clone, MAPPED_MASK) && hasMask(*parent, MAPPED_MASK) &&
+        isNotInInvisibleWorkspace(*clone);
+}
+uint32_t refreshClones(uint32_t budget) {
+    uint32_t start = getTime();
+    uint32_t count = 0;
+    if(!nextCloneToRefresh)
+        lastCloneRefreshTime = start;
+    while(nextCloneToRefresh < clones.size) {
+        if(count && getTime() - start >= budget) {
+            TRACE("Clone refresh exceeded budget; resuming from %d next frame", nextCloneToRefresh);
+            return count;
+        }
+        WindowInfo* clone, *parent;
+        CloneInfo* info = getElement(&clones, nextCloneToRefresh++);
+        if(isCloneRefreshable(info, &clone, &parent)) {
+            copyParentIntoClone(info, clone, parent);
+            count++;
+        }
+    }
+    nextCloneToRefresh = 0;
+    return count;
+}
+static uint32_t getTimeUntilNextCloneRefresh(void) {
+    uint32_t elapsed = getTime() - lastCloneRefreshTime;
+    return nextCloneToRefresh || elapsed >= CLONE_REFRESH_RATE ? 0 : CLONE_REFRESH_RATE - elapsed;
+}
+static void refreshClonesIfDue(void) {
+    if(!getTimeUntilNextCloneRefresh())
+        refreshClones(CLONE_REFRESH_BUDGET);
+}
+static void onCloneRefreshTimer(int fd) {
+    uint64_t expirations;
+    if(read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+        refreshClonesIfDue();
+        flush();
+    }
+}
+/**
+ * Wakes up the event loop when the next refresh is due.
+ * The timer is one-shot so it never starves the IDLE rules; while events are being processed refreshes happen on IDLE
+ */
+static void armCloneRefreshTimer(void) {
+    if(!clones.size)
+        return;
+    uint32_t delay = MAX(getTimeUntilNextCloneRefresh(), 1);
+    struct itimerspec spec = {.it_value = {.tv_sec = delay / 1000, .tv_nsec = (delay % 1000) * 1000000L}};
+    timerfd_settime(cloneRefreshTimerFD, 0, &spec, NULL);
+}
+void autoUpdateClones() {
+    if(cloneRefreshTimerFD != -1)
+        return;
+    cloneRefreshTimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(cloneRefreshTimerFD == -1) {
+        WARN("could not create timer to refresh clones");
+        return;
+    }
+    addExtraEvent(cloneRefreshTimerFD, POLLIN, onCloneRefreshTimer);
+    addEvent(IDLE, DEFAULT_EVENT(refreshClonesIfDue));
+    addEvent(TRUE_IDLE, DEFAULT_EVENT(armCloneRefreshTimer));
+}
 
 void swapWithOriginalOnEnter(xcb_input_enter_event_t* event) {
     WindowInfo* clone = getWindowInfo(event->event);
@@ -139,7 +379,10 @@ void onExpose(xcb_expose_event_t* event) {
             WindowInfo* parent = getParent(winInfo);
             if(parent && isNotInInvisibleWorkspace(parent))
                 updateClone(winInfo, parent);
-            updateAllClonesOfWindow(winInfo);
+            // the repainted area will be reported as damaged
+            CloneSource* source = getCloneSource(winInfo->id);
+            if(source && !source->damage)
+                updateAllClonesOfWindow(winInfo);
         }
     }
 }
@@ -167,8 +410,10 @@ void swapOnMapEvent(xcb_map_notify_event_t* event) {
 void swapOnUnmapEvent(xcb_unmap_notify_event_t* event) {
     WindowInfo* parent = getWindowInfo(event->window);
     if(parent) {
-        FOR_EACH(WindowInfo*, clone, getAllWindows()) {
-            if(isCloneOf(clone, parent) && isNotInInvisibleWorkspace(clone)) {
+        ArrayList* parentClones = getClonesOf(parent);
+        FOR_EACH(CloneInfo*, info, parentClones) {
+            WindowInfo* clone = getWindowInfo(info->cloneID);
+            if(clone && isNotInInvisibleWorkspace(clone)) {
                 swapWindows(clone, parent);
                 mapWindow(parent->id);
                 unmapWindow(clone->id);
@@ -176,23 +421,53 @@ void swapOnUnmapEvent(xcb_unmap_notify_event_t* event) {
         }
     }
 }
+static void freeCloneSource(CloneSource* source) {
+    if(source->damage)
+        XCALL(xcb_damage_destroy, dis, source->damage);
+    clearArray(&source->clones);
+    free(source);
+}
+static void onCloneSourceDestroy(xcb_destroy_notify_event_t* event) {
+    // The damage object is automatically freed by the server when the window is destroyed
+    CloneSource* source = getCloneSource(event->window);
+    if(source)
+        source->damage = 0;
+}
 void onCloneUnregister(WindowInfo* winInfo) {
     CloneInfo* info = removeElement(&clones, winInfo, sizeof(WindowID));
     if(info) {
+        CloneSource* source = getCloneSource(info->originalID);
+        if(source) {
+            removeElementByPointer(&source->clones, info);
+            if(!source->clones.size)
+                freeCloneSource(removeElementByPointer(&cloneSources, source));
+        }
         free(info);
     }
+    CloneSource* source = removeElement(&cloneSources, winInfo, sizeof(WindowID));
+    if(source)
+        freeCloneSource(source);
+}
+uint32_t getCloneSourceDamage(WindowID original) {
+    CloneSource* source = getCloneSource(original);
+    return source ? source->damage : 0;
 }
 
 void addCloneRules(void) {
     //getEventRules(XCB_INPUT_MOTION + GENERIC_EVENT_OFFSET).add( &swapWithOriginalRule);
     addEvent(UNREGISTER_WINDOW, DEFAULT_EVENT(killAllClones, HIGH_PRIORITY));
     addEvent(UNREGISTER_WINDOW, DEFAULT_EVENT(onCloneUnregister));
+    addEvent(XCB_DESTROY_NOTIFY, DEFAULT_EVENT(onCloneSourceDestroy, HIGHEST_PRIORITY));
     addEvent(XCB_EXPOSE, DEFAULT_EVENT(onExpose));
     addEvent(XCB_INPUT_ENTER + GENERIC_EVENT_OFFSET, DEFAULT_EVENT(swapWithOriginalOnEnter));
     addEvent(XCB_INPUT_FOCUS_IN + GENERIC_EVENT_OFFSET, DEFAULT_EVENT(focusParent));
     addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(swapOnMapEvent));
     addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(swapOnUnmapEvent));
     addEvent(X_CONNECTION, DEFAULT_EVENT(create_graphics_context));
+    addEvent(X_CONNECTION, DEFAULT_EVENT(initDamageExtension));
+    addEvent(EXTRA_EVENT, DEFAULT_EVENT(onDamageNotify));
+    addEvent(IDLE, DEFAULT_EVENT(onIdleUpdateDamagedClones));
+    addEvent(WINDOW_TITLE_CHANGE, DEFAULT_EVENT(syncCloneTitles));
 }
 
 
@@ -204,9 +479,9 @@ void swapWindows(WindowInfo* winInfo1, WindowInfo* winInfo2) {
     if(w1 && w2) {
         swapElements(
             getWorkspaceWindowStack(w1),
-            getIndex(getWorkspaceWindowStack(w1), winInfo1, sizeof(WindowID)),
+            getIndexOfPointer(getWorkspaceWindowStack(w1), winInfo1),
             getWorkspaceWindowStack(w2),
-            getIndex(getWorkspaceWindowStack(w2), winInfo2, sizeof(WindowID))
+            getIndexOfPointer(getWorkspaceWindowStack(w2), winInfo2)
         );
     }
     Rect geo = getRealGeometry(winInfo2->id);
@@ -10,6 +10,8 @@
 
 /// How often autoUpdateClones will update cloned windows (in ms)
 extern uint32_t CLONE_REFRESH_RATE;
+/// Max time (in ms) spent refreshing clones per frame; the remaining clones will be refreshed next frame
+extern uint32_t CLONE_REFRESH_BUDGET;
 
 /**
  * Creates a new window and immediate processes.
@@ -41,14 +43,44 @@ uint32_t updateAllClones(void);
 void updateAllClonesOfWindow(WindowInfo* parent);
 
 /**
- * Auto update cloned window every CLONE_REFRESH_RATE ms
+ * Copies the areas of cloned windows that have been drawn to since the last call into their clones.
+ * Damage is accumulated as it is reported, so multiple draws between calls result in a single copy per area.
+ * Called once per frame (on IDLE) when the damage extension is supported.
+ *
+ * @return number of clones updated
+ */
+uint32_t updateDamagedClones(void);
+/**
+ * @return an estimate of the total number of bytes copied from cloned windows into their clones
+ */
+uint64_t getCloneBytesCopied(void);
+/**
+ * @param original a window that has been cloned
+ * @return the damage object monitoring original or 0 if there isn't one
+ */
+uint32_t getCloneSourceDamage(WindowID original);
+
+/**
+ * Refreshes visible clones, resuming from where the last call stopped.
+ * Clones that are unmapped, on an invisible workspace or whose original isn't mapped are skipped.
+ * At least one visible clone is refreshed per call, so progress is made even with a budget of 0
+ *
+ * @param budget the max time to spend (in ms)
+ *
+ * @return number of clones refreshed
+ */
+uint32_t refreshClones(uint32_t budget);
+/**
+ * Auto update cloned window every CLONE_REFRESH_RATE ms.
+ * Updates are spread across frames so no more than CLONE_REFRESH_BUDGET ms is spent at a time
  */
 void autoUpdateClones();
 /**
  * Add rules for seamless interaction with cloned windows
  *
  * Cloned windows will now swap with the original, when the mouse enters
- * Clones will be repainted when original is exposed
+ * Clones will be repainted when original is exposed or, if the damage extension is supported, only the areas of the
+ * original that have changed will be repainted
  */
 void addCloneRules(void);
 
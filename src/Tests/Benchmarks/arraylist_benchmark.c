@@ -0,0 +1,54 @@
+#include <stdlib.h>
+
+#include "../../util/arraylist.h"
+#include "benchmark.h"
+
+#define LIST_SIZE 1000
+#define ITERATIONS 100000
+
+typedef struct {
+    unsigned int id;
+    char padding[60];
+} Element;
+
+static ArrayList list;
+static Element elements[LIST_SIZE];
+
+static void fillList(void) {
+    clearArray(&list);
+    for(int i = 0; i < LIST_SIZE; i++) {
+        elements[i].id = i;
+        addElement(&list, &elements[i]);
+    }
+}
+
+int main(int argc, const char* const argv[]) {
+    BENCHMARK("addElement", ITERATIONS, {
+        if(list.size == LIST_SIZE)
+            clearArray(&list);
+        addElement(&list, &elements[list.size]);
+    });
+    fillList();
+    BENCHMARK("getElement", ITERATIONS * 10, benchmarkSink += ((Element*)getElement(&list, _i % LIST_SIZE))->id);
+    BENCHMARK("FOR_EACH (1000 elements)", ITERATIONS / 100, {
+        FOR_EACH(Element*, element, &list) {
+            benchmarkSink += element->id;
+        }
+    });
+    BENCHMARK("getIndex (1000 elements)", ITERATIONS / 100, {
+        benchmarkSink += getIndex(&list, &elements[LIST_SIZE - 1 - _i % 10], sizeof(unsigned int));
+    });
+    BENCHMARK("getIndexOfPointer (1000 elements)", ITERATIONS / 100, {
+        benchmarkSink += getIndexOfPointer(&list, &elements[LIST_SIZE - 1 - _i % 10]);
+    });
+    BENCHMARK("removeIndex/addElementAt head", ITERATIONS, addElementAt(&list, removeIndex(&list, 0), 0));
+    BENCHMARK("shiftToHead tail", ITERATIONS, shiftToHead(&list, LIST_SIZE - 1));
+    BENCHMARK("pop/push", ITERATIONS, push(&list, pop(&list)));
+    BENCHMARK("fill and drain", ITERATIONS / 100, {
+        fillList();
+        while(list.size)
+            pop(&list);
+    });
+    clearArray(&list);
+    return finishBenchmarks(argc, argv);
+}
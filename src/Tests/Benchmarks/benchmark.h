@@ -0,0 +1,163 @@
+/**
+ * @file benchmark.h
+ * Minimal helpers to time micro benchmarks
+ *
+ * Results can be written as a JSON object mapping the name of each benchmark to its ns/op and compared against
+ * a previously written file; see finishBenchmarks
+ */
+#ifndef MPX_BENCHMARK_H_
+#define MPX_BENCHMARK_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// max number of results that will be recorded
+#define MAX_BENCHMARK_RESULTS 64
+/// max length of the name of a benchmark
+#define MAX_BENCHMARK_NAME_LEN 64
+/// default max slow down (as a fraction) compared to the baseline before a result is considered a regression
+#define DEFAULT_BENCHMARK_TOLERANCE .25
+
+/// The time taken by a single benchmark
+typedef struct {
+    char name[MAX_BENCHMARK_NAME_LEN];
+    double nsPerOp;
+} BenchmarkResult;
+static BenchmarkResult benchmarkResults[MAX_BENCHMARK_RESULTS];
+static int numBenchmarkResults;
+
+/// written to by benchmarks so the compiler cannot optimize the work away
+static volatile long benchmarkSink;
+
+/**
+ * @return a monotonic timestamp in ns
+ */
+static inline long getNanoTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+/**
+ * Prints the average time taken per iteration
+ *
+ * @param name
+ * @param iterations
+ * @param ns total time taken
+ */
+static inline void reportBenchmark(const char* name, long iterations, long ns) {
+    printf("%-36s %10ld iterations %12.2f ns/op\n", name, iterations, (double)ns / iterations);
+    if(numBenchmarkResults < MAX_BENCHMARK_RESULTS) {
+        BenchmarkResult* result = &benchmarkResults[numBenchmarkResults++];
+        strncpy(result->name, name, MAX_BENCHMARK_NAME_LEN - 1);
+        result->nsPerOp = (double)ns / iterations;
+    }
+}
+
+/**
+ * Writes every recorded result to path as a JSON object with one "name": ns/op pair per line
+ *
+ * @param path
+ *
+ * @return 0 on success
+ */
+static inline int writeBenchmarkResults(const char* path) {
+    FILE* file = fopen(path, "w");
+    if(!file) {
+        perror(path);
+        return 1;
+    }
+    fprintf(file, "{\n");
+    for(int i = 0; i < numBenchmarkResults; i++)
+        fprintf(file, "    \"%s\": %.2f%s\n", benchmarkResults[i].name, benchmarkResults[i].nsPerOp,
+            i + 1 < numBenchmarkResults ? "," : "");
+    fprintf(file, "}\n");
+    fclose(file);
+    return 0;
+}
+
+/**
+ * Compares every recorded result against those in a file written by writeBenchmarkResults.
+ * Benchmarks missing from either side are ignored.
+ *
+ * @param path the baseline
+ * @param tolerance max allowed slow down as a fraction of the baseline
+ *
+ * @return the number of results that are slower than the baseline by more than tolerance or -1 if the baseline
+ * couldn't be read
+ */
+static inline int compareBenchmarkResults(const char* path, double tolerance) {
+    FILE* file = fopen(path, "r");
+    if(!file) {
+        perror(path);
+        return -1;
+    }
+    int regressions = 0;
+    char line[MAX_BENCHMARK_NAME_LEN * 2];
+    char name[MAX_BENCHMARK_NAME_LEN];
+    double baseline;
+    printf("\n%-36s %12s %12s %8s\n", "benchmark", "baseline", "current", "change");
+    while(fgets(line, sizeof(line), file)) {
+        if(sscanf(line, " \"%63[^\"]\": %lf", name, &baseline) != 2)
+            continue;
+        for(int i = 0; i < numBenchmarkResults; i++)
+            if(strcmp(benchmarkResults[i].name, name) == 0) {
+                double change = benchmarkResults[i].nsPerOp / baseline - 1;
+                bool regressed = change > tolerance;
+                printf("%-36s %12.2f %12.2f %+7.1f%%%s\n", name, baseline, benchmarkResults[i].nsPerOp, change * 100,
+                    regressed ? " REGRESSION" : "");
+                regressions += regressed;
+                break;
+            }
+    }
+    fclose(file);
+    return regressions;
+}
+
+/**
+ * Handles the common arguments of benchmark binaries:
+ * --json PATH writes the results to PATH,
+ * --compare PATH compares the results against the baseline at PATH and
+ * --tolerance FRACTION overrides DEFAULT_BENCHMARK_TOLERANCE
+ *
+ * @param argc
+ * @param argv
+ *
+ * @return the exit code of the benchmark binary; non-zero if there were regressions
+ */
+static inline int finishBenchmarks(int argc, const char* const argv[]) {
+    const char* jsonPath = NULL;
+    const char* baselinePath = NULL;
+    double tolerance = DEFAULT_BENCHMARK_TOLERANCE;
+    for(int i = 1; i + 1 < argc; i++) {
+        if(strcmp(argv[i], "--json") == 0)
+            jsonPath = argv[++i];
+        else if(strcmp(argv[i], "--compare") == 0)
+            baselinePath = argv[++i];
+        else if(strcmp(argv[i], "--tolerance") == 0)
+            tolerance = atof(argv[++i]);
+    }
+    if(jsonPath && writeBenchmarkResults(jsonPath))
+        return 1;
+    if(baselinePath) {
+        int regressions = compareBenchmarkResults(baselinePath, tolerance);
+        if(regressions > 0)
+            printf("%d benchmark(s) regressed by more than %.0f%%\n", regressions, tolerance * 100);
+        return regressions != 0;
+    }
+    return 0;
+}
+
+/**
+ * Runs BODY ITERATIONS times and reports the average time per iteration.
+ * The current iteration is available as _i
+ */
+#define BENCHMARK(NAME, ITERATIONS, BODY) do { \
+        long __start = getNanoTime(); \
+        for(long _i = 0; _i < (ITERATIONS); _i++) { BODY; } \
+        reportBenchmark(NAME, ITERATIONS, getNanoTime() - __start); \
+    } while(0)
+#endif
@@ -0,0 +1,146 @@
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../../Extensions/session.h"
+#include "../../functions.h"
+#include "../../globals.h"
+#include "../../layouts.h"
+#include "../../masters.h"
+#include "../../settings.h"
+#include "../../system.h"
+#include "../../util/ipc-socket.h"
+#include "../../util/logger.h"
+#include "../../wmfunctions.h"
+#include "../../workspaces.h"
+#include "../../xevent.h"
+#include "../../xutil/window-properties.h"
+#include "../../xutil/xsession.h"
+#include "benchmark.h"
+
+/// number of windows managed during each benchmark; the results of "map windows" are per batch of NUM_WINDOWS
+#define NUM_WINDOWS 100
+#define ITERATIONS 100
+/// number of workspaces, each with NUM_WINDOWS windows, cycled through by "switch across workspaces"
+#define NUM_WORKSPACES 10
+
+static WindowID windows[NUM_WINDOWS];
+
+/**
+ * Runs the event loop until the WM has responded to every event
+ */
+static void processEventsUntilIdle(void) {
+    flush();
+    runEventLoop();
+}
+static void createWindows(void) {
+    for(int i = 0; i < NUM_WINDOWS; i++)
+        windows[i] = mapWindow(createWindow(root, XCB_WINDOW_CLASS_INPUT_OUTPUT, 0, NULL, (Rect) {0, 0, 10, 10}));
+}
+static void destroyWindows(void) {
+    for(int i = 0; i < NUM_WINDOWS; i++)
+        xcb_destroy_window(dis, windows[i]);
+    processEventsUntilIdle();
+}
+
+/**
+ * Measures switching between workspaces when every workspace has windows in it
+ */
+static void benchmarkSwitchAcrossWorkspaces(void) {
+    static WindowID workspaceWindows[NUM_WORKSPACES][NUM_WINDOWS];
+    for(int w = 0; w < NUM_WORKSPACES; w++) {
+        switchToWorkspace(w);
+        for(int i = 0; i < NUM_WINDOWS; i++)
+            workspaceWindows[w][i] = mapWindow(createWindow(root, XCB_WINDOW_CLASS_INPUT_OUTPUT, 0, NULL,
+                        (Rect) {0, 0, 10, 10}));
+        processEventsUntilIdle();
+    }
+    BENCHMARK("switch across " _STR(NUM_WORKSPACES) " workspaces", ITERATIONS, {
+        switchToWorkspace(_i % NUM_WORKSPACES);
+        processEventsUntilIdle();
+    });
+    switchToWorkspace(0);
+    for(int w = 0; w < NUM_WORKSPACES; w++)
+        for(int i = 0; i < NUM_WINDOWS; i++)
+            xcb_destroy_window(dis, workspaceWindows[w][i]);
+    processEventsUntilIdle();
+}
+
+static void startWM(void) {
+    startupMethod = loadSettings;
+    onStartup();
+}
+
+/**
+ * Measures the time for a request sent from a client to be run by the WM and for the client to get the response
+ */
+static void benchmarkIPCRoundTrip(void) {
+    int pid = fork();
+    if(!pid) {
+        startWM();
+        runEventLoop();
+        exit(0);
+    }
+    while(sendOverIPCSocket("log-level", 0, "4", NULL) == -1)
+        poll(NULL, 0, 10);
+    BENCHMARK("ipc round trip", ITERATIONS * 10, sendOverIPCSocket("log-level", 0, "4", NULL));
+    sendOverIPCSocket("quit", 0, NULL, NULL);
+    waitForChild(pid);
+}
+
+int main(int argc, const char* const argv[]) {
+    char* logLevelStr = getenv("LOG_LEVEL");
+    setLogLevel(logLevelStr ? atoi(logLevelStr) : LOG_LEVEL_WARN);
+    benchmarkIPCRoundTrip();
+
+    addResumeCustomStateRules();
+    startWM();
+    addShutdownOnIdleRule();
+    processEventsUntilIdle();
+
+    long mapTime = 0;
+    for(int i = 0; i < ITERATIONS / 10; i++) {
+        long start = getNanoTime();
+        createWindows();
+        processEventsUntilIdle();
+        mapTime += getNanoTime() - start;
+        destroyWindows();
+    }
+    reportBenchmark("map windows", ITERATIONS / 10, mapTime);
+
+    createWindows();
+    processEventsUntilIdle();
+    BENCHMARK("retile", ITERATIONS, {
+        retile();
+        processEventsUntilIdle();
+    });
+    BENCHMARK("switch workspace", ITERATIONS, {
+        switchToWorkspace(_i % 2);
+        processEventsUntilIdle();
+    });
+    switchToWorkspace(0);
+    processEventsUntilIdle();
+    setFocusStackFrozen(1);
+    BENCHMARK("alt-tab cycle", ITERATIONS * 10, {
+        cycleWindows(DOWN);
+        processEventsUntilIdle();
+    });
+    setFocusStackFrozen(0);
+    USE_POSIX_SPAWN = 0;
+    BENCHMARK("spawn true (fork)", ITERATIONS * 10, spawn("true"));
+    BENCHMARK("spawnAndWait true (fork)", ITERATIONS * 10, spawnAndWait("true"));
+    USE_POSIX_SPAWN = 1;
+    BENCHMARK("spawn true (posix_spawn)", ITERATIONS * 10, spawn("true"));
+    BENCHMARK("spawnAndWait true (posix_spawn)", ITERATIONS * 10, spawnAndWait("true"));
+    while(getNumberOfDetachedChildren())
+        reapDetachedChildren();
+    BENCHMARK("restart state save and restore", ITERATIONS, {
+        saveCustomState();
+        loadSavedNonWindowState();
+        loadSavedWindowState();
+        processEventsUntilIdle();
+    });
+    destroyWindows();
+    benchmarkSwitchAcrossWorkspaces();
+    return finishBenchmarks(argc, argv);
+}
@@ -8,6 +8,7 @@
 
 #include "../../Extensions/containers.h"
 #include "../../Extensions/session.h"
+#include "../../devices.h"
 #include "../../functions.h"
 #include "../../globals.h"
 #include "../../layouts.h"
@@ -168,6 +169,22 @@ SCUTEST(unmapContainer) {
     assert(!hasMask(getWindowInfo(containedWindow), MAPPED_MASK));
 }
 
+SCUTEST(container_churn_does_not_query_randr) {
+    uint32_t count = getRandrRequestCount();
+    for(int i = 0; i < 4; i++) {
+        setWindowPosition(containerWindowInfo->id, (Rect) {i, i, 10 + i, 10 + i});
+        switchToWorkspace(getWorkspaceOfMonitor(containerMonitor)->id);
+        runEventLoop();
+        switchToWorkspace(0);
+        runEventLoop();
+    }
+    WindowID id = createSimpleContainer();
+    runEventLoop();
+    destroyWindow(id);
+    runEventLoop();
+    assertEquals(count, getRandrRequestCount());
+}
+
 SCUTEST(persist_after_monitor_refresh) {
     detectMonitors();
     assert(getMonitorByID(container));
@@ -1,6 +1,7 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xproto.h>
+#include <xcb/damage.h>
 #include <xcb/xcb.h>
 #include <xcb/xcb_ewmh.h>
 #include <xcb/xcb_icccm.h>
@@ -39,7 +40,7 @@ SCUTEST_SET_ENV(setup, cleanupXServer);
 SCUTEST(test_clone_window) {
     assert(getWindowInfo(cloneInfo->id) == cloneInfo);
     assert(getAllWindows()->size == 2);
-    assert(strcmp(cloneInfo->title, winInfo->title) == 0);
+    assert(strcmp(getTitle(cloneInfo), getTitle(winInfo)) == 0);
 }
 SCUTEST(test_sync_properties, .iter = 2) {
     setWindowTitle(winInfo->id, "newTitle");
@@ -47,7 +48,7 @@ SCUTEST(test_sync_properties, .iter = 2) {
         updateAllClonesOfWindow(winInfo);
     else
         updateAllClones();
-    assert(strcmp(cloneInfo->title, winInfo->title) == 0);
+    assert(strcmp(getTitle(cloneInfo), getTitle(winInfo)) == 0);
 }
 SCUTEST_ITER(test_simple_kill_clone, 2) {
     if(_i)
@@ -106,3 +107,78 @@ SCUTEST(delete_parent_before_clone, .iter = 2) {
     assert(!getWindowInfo(clone));
 }
 
+
+SCUTEST(damage_only_copies_changed_area) {
+    uint64_t bytesCopied = getCloneBytesCopied();
+    xcb_gcontext_t gc = xcb_generate_id(dis);
+    xcb_create_gc(dis, gc, winInfo->id, 0, NULL);
+    xcb_rectangle_t rect = {1, 1, 10, 10};
+    // repeated draws to the same area within a frame should only be copied once
+    for(int i = 0; i < 3; i++)
+        xcb_poly_fill_rectangle(dis, winInfo->id, gc, 1, &rect);
+    flush();
+    runEventLoop();
+    uint64_t bytesPerFrame = getCloneBytesCopied() - bytesCopied;
+    uint64_t fullCopy = (uint64_t)cloneInfo->geometry.width * cloneInfo->geometry.height * 4;
+    assert(bytesPerFrame);
+    assert(bytesPerFrame <= rect.width * rect.height * 4);
+    assert(bytesPerFrame < fullCopy);
+    bytesCopied = getCloneBytesCopied();
+    runEventLoop();
+    assertEquals(bytesCopied, getCloneBytesCopied());
+}
+
+SCUTEST(unregister_source_frees_damage) {
+    uint32_t damage = getCloneSourceDamage(winInfo->id);
+    if(!damage)
+        return;
+    WindowID win = winInfo->id;
+    unregisterWindow(winInfo, 1);
+    runEventLoop();
+    assert(!getCloneSourceDamage(win));
+    assert(catchErrorSilent(xcb_damage_subtract_checked(dis, damage, XCB_NONE, XCB_NONE)));
+}
+
+SCUTEST(kill_clones_of_single_parent) {
+    WindowID win = mapWindow(createNormalWindow());
+    runEventLoop();
+    WindowInfo* other = getWindowInfo(win);
+    assert(other);
+    for(int i = 0; i < 3; i++) {
+        cloneWindow(winInfo);
+        cloneWindow(other);
+    }
+    runEventLoop();
+    assertEquals(getAllWindows()->size, 2 + 1 + 3 + 3);
+    killAllClones(winInfo);
+    runEventLoop();
+    assertEquals(getAllWindows()->size, 2 + 3);
+    assert(getWindowInfo(winInfo->id));
+    killAllClones(other);
+    runEventLoop();
+    assertEquals(getAllWindows()->size, 2);
+}
+
+SCUTEST(refresh_skips_hidden_clones) {
+    assertEquals(refreshClones(-1), 1);
+    moveToWorkspace(cloneInfo, 1);
+    runEventLoop();
+    assert(!isWindowMapped(cloneInfo->id));
+    assertEquals(refreshClones(-1), 0);
+}
+
+SCUTEST(refresh_spread_across_frames) {
+    for(int i = 0; i < 9; i++)
+        cloneWindow(winInfo);
+    runEventLoop();
+    for(int i = 0; i < 10; i++)
+        assertEquals(refreshClones(0), 1);
+    assertEquals(refreshClones(-1), 10);
+}
+
+SCUTEST(auto_update_clones) {
+    autoUpdateClones();
+    uint64_t bytesCopied = getCloneBytesCopied();
+    runEventLoop();
+    assert(getCloneBytesCopied() > bytesCopied);
+}
@@ -1,6 +1,13 @@
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "tester.h"
 #include "test-event-helper.h"
 #include "../communications.h"
+#include "../system.h"
+#include "../util/ipc-socket.h"
+#include "../windows.h"
 #include "../wmfunctions.h"
 
 static void checkAndSend(const char* name, const char* value) {
@@ -57,6 +64,93 @@ SCUTEST(test_send_receive_as, .iter = 2) {
     }
 }
 
+SCUTEST(test_send_receive_socket, .iter = 2) {
+    int fd = connectToIPCSocket();
+    assert(fd != -1);
+    assertEquals(0, sendIPCSocketRequest(fd, _i ? "bad_option" : "log-level", 0, "0", NULL));
+    addShutdownOnIdleRule();
+    runEventLoop();
+    assertEquals(_i ? INVALID_OPTION : NORMAL_TERMINATION, receiveIPCSocketResponse(fd));
+    close(fd);
+    if(!_i)
+        assertEquals(getLogLevel(), 0);
+}
+
+SCUTEST(test_socket_output) {
+    int fds[2];
+    assert(!pipe(fds));
+    int savedStdout = dup(STDOUT_FILENO);
+    dup2(fds[1], STDOUT_FILENO);
+    int fd = connectToIPCSocket();
+    assertEquals(0, sendIPCSocketRequest(fd, "sum", 0, NULL, NULL));
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    close(fds[1]);
+    addShutdownOnIdleRule();
+    runEventLoop();
+    assertEquals(0, receiveIPCSocketResponse(fd));
+    close(fd);
+    char buffer[8];
+    assert(read(fds[0], buffer, sizeof(buffer)) > 0);
+}
+
+SCUTEST(test_socket_request_sent_in_pieces) {
+    const char payload[] = "log-level\0" "0";
+    IPCRequestHeader header = {.numCommands = 1, .len = sizeof(payload) + 1};
+    int fd = connectToIPCSocket();
+    assert(write(fd, &header, sizeof(header) / 2) == sizeof(header) / 2);
+    addShutdownOnIdleRule();
+    // the rest of the request shouldn't be waited on
+    runEventLoop();
+    assert(write(fd, (char*)&header + sizeof(header) / 2, sizeof(header) - sizeof(header) / 2) > 0);
+    assert(write(fd, payload, sizeof(payload)) == sizeof(payload));
+    assert(write(fd, "", 1) == 1);
+    runEventLoop();
+    assertEquals(NORMAL_TERMINATION, receiveIPCSocketResponse(fd));
+    close(fd);
+    assertEquals(getLogLevel(), 0);
+}
+
+SCUTEST(test_socket_private_dir) {
+    unsetenv("XDG_RUNTIME_DIR");
+    int fd = createIPCSocket();
+    assert(fd != -1);
+    struct stat info;
+    assert(!stat(getIPCSocketDir(), &info));
+    assertEquals(info.st_uid, getuid());
+    assertEquals(info.st_mode & 0777, S_IRWXU);
+    assert(!stat(getIPCSocketPath(), &info));
+    assert(!(info.st_mode & (S_IRWXG | S_IRWXO)));
+    close(fd);
+    unlink(getIPCSocketPath());
+    // refuse to listen in a directory that others can access
+    chmod(getIPCSocketDir(), S_IRWXU | S_IRWXG | S_IRWXO);
+    assertEquals(-1, createIPCSocket());
+    chmod(getIPCSocketDir(), S_IRWXU);
+}
+
+SCUTEST(test_socket_batch) {
+    WindowID win = mapWindow(createNormalWindow());
+    registerWindow(win, root, NULL);
+    moveToWorkspace(getWindowInfo(win), 0);
+    addEvent(TILE_WORKSPACE, DEFAULT_EVENT(incrementCount));
+    IPCCommand commands[] = {{"retile"}, {"log-level", "0"}, {"bad_option"}, {"retile"}};
+    int fd = connectToIPCSocket();
+    assertEquals(0, sendIPCSocketBatchRequest(fd, 0, commands, LEN(commands)));
+    addShutdownOnIdleRule();
+    runEventLoop();
+    int statuses[LEN(commands)];
+    assertEquals(0, receiveIPCSocketBatchResponse(fd, statuses, LEN(commands)));
+    close(fd);
+    assertEquals(NORMAL_TERMINATION, statuses[0]);
+    assertEquals(NORMAL_TERMINATION, statuses[1]);
+    assertEquals(INVALID_OPTION, statuses[2]);
+    assertEquals(NORMAL_TERMINATION, statuses[3]);
+    assertEquals(getLogLevel(), 0);
+    // tiling is deferred until the whole batch has been processed
+    assertEquals(1, getCount());
+}
+
 SCUTEST(bad_pid) {
     CRASH_ON_ERRORS = 0;
     catchError(xcb_ewmh_set_wm_pid_checked(ewmh, getPrivateWindow(), -1));
@@ -1,6 +1,7 @@
 #include "../Extensions/ewmh-client.h"
 #include "../communications.h"
 #include "../system.h"
+#include "../util/time.h"
 #include "../windows.h"
 #include "../wmfunctions.h"
 #include "test-wm-helper.h"
@@ -82,6 +83,15 @@ SCUTEST_ITER(wm_restart_recursive, 3) {
         WAIT_UNTIL_TRUE(isMPXManagerRunning());
     }
 }
+SCUTEST(bench_ipc_transports, .iter = 2, .timeout = 60) {
+    const char* transports[] = {"socket", "x"};
+    const char* commands[] = {"./mpxmanager log-level 2", "./mpxmanager --no-ipc-socket log-level 2"};
+    unsigned int start = getTime();
+    for(int i = 0; i < 1000; i++)
+        assertEquals(0, spawnAndWait(commands[_i]));
+    printf("1000 sequential commands over the %s transport took %ums\n", transports[_i], getTime() - start);
+}
+
 SCUTEST(test_send_as) {
     char buffer[255];
     createMasterDevice("test");
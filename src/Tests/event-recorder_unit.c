@@ -0,0 +1,61 @@
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "tester.h"
+#include "test-x-helper.h"
+#include "test-event-helper.h"
+#include "../event-recorder.h"
+
+static char path[] = "/tmp/mpx-recording-XXXXXX";
+static void setup() {
+    close(mkstemp(path));
+    unlink(path);
+    openXDisplay();
+    addShutdownOnIdleRule();
+    registerForWindowEvents(root, ROOT_EVENT_MASKS);
+}
+static void cleanup() {
+    stopRecordingEvents();
+    unlink(path);
+    simpleCleanup();
+}
+SCUTEST_SET_ENV(setup, cleanup);
+
+SCUTEST(test_record_replay) {
+    int numEvents = 10;
+    addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(incrementCount));
+    addEvent(IDLE, DEFAULT_EVENT(decrementCount));
+    assert(startRecordingEvents(path));
+    assert(isRecordingEvents());
+    xcb_generic_event_t event = {.response_type = XCB_UNMAP_NOTIFY};
+    for(int i = 0; i < numEvents; i++)
+        xcb_send_event(dis, 0, root, ROOT_EVENT_MASKS, (char*) &event);
+    runEventLoop();
+    stopRecordingEvents();
+    assert(!isRecordingEvents());
+    int count = getAndResetCount();
+    assertEquals(replayEvents(path, NULL), numEvents);
+    assertEquals(getCount(), count);
+}
+
+SCUTEST(test_record_appends) {
+    assert(startRecordingEvents(path));
+    xcb_generic_event_t event = {.response_type = XCB_UNMAP_NOTIFY};
+    recordEvent(&event);
+    recordIdle();
+    assert(startRecordingEvents(path));
+    recordEvent(&event);
+    stopRecordingEvents();
+    addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(incrementCount));
+    addEvent(IDLE, DEFAULT_EVENT(incrementCount));
+    assertEquals(replayEvents(path, NULL), 2);
+    assertEquals(getCount(), 3);
+}
+
+SCUTEST(test_replay_invalid_recording) {
+    assertEquals(replayEvents(path, NULL), -1);
+    FILE* file = fopen(path, "w");
+    fprintf(file, "not a recording");
+    fclose(file);
+    assertEquals(replayEvents(path, NULL), -1);
+}
@@ -134,13 +134,37 @@ SCUTEST_ITER(stable, 2) {
 
 SCUTEST(test_dock_not_auto_in_workspace) {
     void func(WindowInfo * winInfo) {
-        winInfo->dock = 1;
+        markAsDock(winInfo);
     }
     addEvent(CLIENT_MAP_ALLOW, DEFAULT_EVENT(func, HIGHEST_PRIORITY));
     WindowID win = mapWindow(createNormalWindow());
     runEventLoop();
     assert(!getWorkspaceOfWindow(getWindowInfo(win)));
 }
+SCUTEST(only_sync_workspaces_with_mapped_windows) {
+    WindowID win = mapWindow(createNormalWindow());
+    runEventLoop();
+    WindowInfo* winInfo = getWindowInfo(win);
+    moveToWorkspace(winInfo, 2);
+    assert(getWorkspace(2)->mapped);
+    runEventLoop();
+    assert(!isWindowMapped(win));
+    assert(!getWorkspace(2)->mapped);
+    // invisible workspaces that aren't marked as mapped aren't touched
+    addMask(winInfo, MAPPED_MASK);
+    switchToWorkspace(1);
+    runEventLoop();
+    assert(hasMask(winInfo, MAPPED_MASK));
+    removeMask(winInfo, MAPPED_MASK);
+    switchToWorkspace(2);
+    runEventLoop();
+    assert(isWindowMapped(win));
+    assert(getWorkspace(2)->mapped);
+    switchToWorkspace(0);
+    runEventLoop();
+    assert(!isWindowMapped(win));
+    assert(!getWorkspace(2)->mapped);
+}
 
 
 void replayKeyboardEvent();
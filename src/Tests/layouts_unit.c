@@ -3,6 +3,7 @@
 #include "../monitors.h"
 #include "../wmfunctions.h"
 #include "../functions.h"
+#include "../xutil/fake-x-backend.h"
 #include "test-event-helper.h"
 #include "test-mpx-helper.h"
 #include "test-x-helper.h"
@@ -276,3 +277,43 @@ SCUTEST(test_register_restore_layout) {
     assert(!memcmp(&c.args, &args, sizeof(LayoutArgs)));
     toggleActiveLayout(NULL);
 }
+
+static void createFakeXEnv(void) {
+    useFakeXBackend();
+    createSimpleEnv();
+    addFakeMonitor((Rect) {0, 0, 100, 200});
+    assignUnusedMonitorsToWorkspaces();
+}
+static void cleanupFakeXEnv(void) {
+    simpleCleanup();
+    useXCBBackend();
+}
+SCUTEST_SET_ENV(createFakeXEnv, cleanupFakeXEnv);
+
+SCUTEST(test_tile_request_count) {
+    int numWindows = 5;
+    toggleActiveLayout(&LAYOUT_FAMILIES[1]);
+    for(int i = 1; i <= numWindows; i++) {
+        WindowInfo* winInfo = newWindowInfo(i, 0);
+        moveToWorkspace(winInfo, 0);
+        addMask(winInfo, MAPPABLE_MASK | MAPPED_MASK);
+    }
+    resetFakeXRequestCounts();
+    retile();
+    assertEquals(getFakeXRequestCount(X_CONFIGURE_WINDOW), numWindows);
+    assertEquals(getTotalFakeXRequestCount(), numWindows);
+    for(int i = 1; i <= numWindows; i++)
+        assert(getFakeWindowConfig(i, NULL));
+    toggleActiveLayout(NULL);
+}
+
+SCUTEST(test_fake_window_property) {
+    setWindowPropertyInt(1, XCB_ATOM_WM_NAME, XCB_ATOM_CARDINAL, 7);
+    assertEquals(getWindowPropertyValueInt(1, XCB_ATOM_WM_NAME, XCB_ATOM_CARDINAL), 7);
+    assertEquals(getWindowPropertyValueInt(1, XCB_ATOM_WM_NAME, XCB_ATOM_STRING), 0);
+    clearWindowProperty(1, XCB_ATOM_WM_NAME);
+    assertEquals(getWindowPropertyValueInt(1, XCB_ATOM_WM_NAME, XCB_ATOM_CARDINAL), 0);
+    assertEquals(getFakeXRequestCount(X_CHANGE_PROPERTY), 1);
+    assertEquals(getFakeXRequestCount(X_DELETE_PROPERTY), 1);
+    assertEquals(getFakeXRequestCount(X_GET_PROPERTY), 3);
+}
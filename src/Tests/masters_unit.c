@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <scutest/tester.h>
 #include "test-mpx-helper.h"
 #include "tester.h"
@@ -95,6 +96,74 @@ SCUTEST(test_focus_delete) {
     assertEquals(getActiveMasterWindowStack()->size, 0);
 }
 
+/// reference ArrayList based implementation of the focus stack to compare against
+static ArrayList expectedStack;
+static uint32_t expectedFocusedIndex;
+static void expectFocus(WindowInfo* winInfo) {
+    int pos = getIndex(&expectedStack, winInfo, sizeof(WindowID));
+    if(!isFocusStackFrozen()) {
+        if(pos == -1) {
+            pos = expectedStack.size;
+            addElement(&expectedStack, winInfo);
+        }
+        shiftToHead(&expectedStack, pos);
+    }
+    else if(pos != -1)
+        expectedFocusedIndex = pos;
+    else
+        addElementAt(&expectedStack, winInfo, expectedFocusedIndex);
+}
+static void expectRemove(WindowInfo* winInfo) {
+    int index = getIndex(&expectedStack, winInfo, sizeof(WindowID));
+    if(index == -1)
+        return;
+    if(expectedFocusedIndex)
+        expectedFocusedIndex -= expectedFocusedIndex >= index;
+    removeIndex(&expectedStack, index);
+}
+static void expectFrozen(bool value) {
+    if(isFocusStackFrozen() != value && expectedFocusedIndex < expectedStack.size) {
+        shiftToHead(&expectedStack, expectedFocusedIndex);
+        expectedFocusedIndex = 0;
+    }
+}
+SCUTEST_ITER(focus_stack_order_matches_array_implementation, 4) {
+    srand(_i);
+    int numWindows = 16;
+    for(int i = 1; i <= numWindows; i++)
+        addFakeWindowInfo(i);
+    for(int n = 0; n < 1000; n++) {
+        int r = rand() % 16;
+        WindowInfo* winInfo = getElement(getAllWindows(), rand() % getAllWindows()->size);
+        if(r == 0) {
+            expectFrozen(!isFocusStackFrozen());
+            setFocusStackFrozen(!isFocusStackFrozen());
+        }
+        else if(r <= 2) {
+            WindowInfo* expected = getIndex(&expectedStack, winInfo, sizeof(WindowID)) == -1 ? NULL : winInfo;
+            expectRemove(winInfo);
+            assertEquals(expected, removeWindowFromFocusStack(getActiveMaster(), winInfo->id));
+        }
+        else if(r == 3) {
+            expectRemove(winInfo);
+            WindowID id = winInfo->id;
+            freeWindowInfo(winInfo);
+            addFakeWindowInfo(id);
+        }
+        else {
+            expectFocus(winInfo);
+            onWindowFocus(winInfo->id);
+        }
+        const ArrayList* stack = getActiveMasterWindowStack();
+        assertEquals(expectedStack.size, stack->size);
+        for(int i = 0; i < stack->size; i++)
+            assertEquals(getElement(&expectedStack, i), getElement(stack, i));
+        WindowInfo* expectedFocus = expectedStack.size ? getElement(&expectedStack, expectedFocusedIndex) : NULL;
+        assertEquals(expectedFocus, getFocusedWindow());
+    }
+    clearArray(&expectedStack);
+}
+
 SCUTEST(test_master_active) {
     assert(getActiveMaster());
     for(int i = DEFAULT_KEYBOARD + DEFAULT_POINTER + 1; i <= 10; i += 2) {
@@ -14,7 +14,7 @@ static void setupEnvWithDock(int i) {
     addWorkspaces(2);
     winInfo = addFakeWindowInfo(1);
     addMask(winInfo, MAPPED_MASK | MAPPABLE_MASK);
-    winInfo->dock = 1;
+    markAsDock(winInfo);
     winInfo->dockProperties = (DockProperties) {i % 4, .thickness = 1};
 }
 SCUTEST_SET_ENV(setupEnvWithDock, simpleCleanup);
@@ -51,6 +51,49 @@ SCUTEST_ITER(test_avoid_docks, 4) {
     assertEquals((getRootWidth() - winInfo->dockProperties.thickness)*getRootWidth(), getArea(monitor->view));
 }
 
+static void assertViewsAvoidAllDocks() {
+    Rect views[getAllMonitors()->size];
+    FOR_EACH(Monitor*, monitor, getAllMonitors()) {
+        views[getIndex(getAllMonitors(), monitor, sizeof(MonitorID))] = monitor->view;
+        monitor->view = monitor->base;
+    }
+    FOR_EACH(WindowInfo*, dock, getAllDocks()) {
+        if(hasMask(dock, MAPPED_MASK))
+            resizeAllMonitorsToAvoidDock(dock);
+    }
+    FOR_EACH(Monitor*, monitor, getAllMonitors()) {
+        assertEqualsRect(views[getIndex(getAllMonitors(), monitor, sizeof(MonitorID))], monitor->view);
+    }
+}
+SCUTEST(test_avoid_many_docks) {
+    const int numMonitors = 8;
+    for(int i = 0; i < numMonitors; i++) {
+        int width = getRootWidth() / (numMonitors / 2);
+        addFakeMonitor((Rect) {i / 2 * width, i % 2 * getRootHeight() / 2, width, getRootHeight() / 2});
+    }
+    assignUnusedMonitorsToWorkspaces();
+    for(int i = 0; i < 50; i++) {
+        WindowInfo* dock = addFakeWindowInfo(i + 2);
+        addMask(dock, MAPPED_MASK | MAPPABLE_MASK);
+        markAsDock(dock);
+        dock->dockProperties = (DockProperties) {i % 4, .thickness = 1, .start = i * 2 % 96, .end = i * 2 % 96 + 2};
+    }
+    assertEquals(50 + 1, getAllDocks()->size);
+    assertEquals(numMonitors, resizeMonitorsWithChangedStruts());
+    assertViewsAvoidAllDocks();
+    assertEquals(0, resizeMonitorsWithChangedStruts());
+
+    // a dock changing only affects the monitors it touches
+    WindowInfo* dock = getWindowInfo(2 + DOCK_TOP);
+    dock->dockProperties.thickness = 2;
+    assertEquals(1, resizeMonitorsWithChangedStruts());
+    assertViewsAvoidAllDocks();
+    removeMask(dock, MAPPED_MASK);
+    assertEquals(1, resizeMonitorsWithChangedStruts());
+    assertViewsAvoidAllDocks();
+    assertEquals(0, resizeMonitorsWithChangedStruts());
+}
+
 SCUTEST_ITER(test_large_docks, 4) {
     winInfo->dockProperties.thickness = getRootWidth();
     Rect base = {0, 0, getRootWidth(), getRootHeight()};
@@ -84,6 +127,17 @@ SCUTEST_ITER(test_monitor_dup_resolution, LEN(masks)) {
         assert(getElement(getAllMonitors(), 0) == (_i < LEN(masks) / 2 ? larger : smaller));
     }
 }
+SCUTEST(test_set_primary_marks_views_dirty) {
+    Monitor* monitor = addFakeMonitor((Rect) {0, 0, 100, 100});
+    Monitor* monitor2 = addFakeMonitor((Rect) {100, 0, 100, 100});
+    setPrimary(monitor->id);
+    resizeAllMonitorsToAvoidAllDocks();
+    assert(!monitor->viewDirty && !monitor2->viewDirty);
+    setPrimary(monitor->id);
+    assert(!monitor->viewDirty && !monitor2->viewDirty);
+    setPrimary(monitor2->id);
+    assert(monitor->viewDirty && monitor2->viewDirty);
+}
 SCUTEST(test_monitor_dup_remove_all) {
     MONITOR_DUPLICATION_POLICY = INTERSECTS | CONTAINS | SAME_DIMS;
     MONITOR_DUPLICATION_RESOLUTION = TAKE_LARGER;
@@ -139,6 +193,40 @@ SCUTEST_ITER(test_monitor_intersection, LEN(monitor_masks)) {
     assertEquals(getElement(getAllMonitors(), 0), winner);
 }
 
+SCUTEST(test_monitors_intersecting) {
+    for(int i = 0; i < 16; i++)
+        addFakeMonitor((Rect) {(15 - i) * 10, 0, 10, 10});
+    Monitor* large = addFakeMonitor((Rect) {0, 0, 100, 100});
+    for(int x = 1; x < 160; x += 10) {
+        const ArrayList* monitors = getMonitorsIntersecting((Rect) {x, 1, 0, 0});
+        assertEquals(monitors->size, x < 100 ? 2 : 1);
+        FOR_EACH(Monitor*, monitor, monitors) {
+            assert(monitor == large || monitor->base.x == x - 1);
+        }
+    }
+    assertEquals(0, getMonitorsIntersecting((Rect) {1, 101, 0, 0})->size);
+    assertEquals(16 + 1, getMonitorsIntersecting((Rect) {0, 0, 160, 1})->size);
+    setBase(large, (Rect) {200, 0, 10, 10});
+    assertEquals(large, getHead(getMonitorsIntersecting((Rect) {201, 1, 0, 0})));
+}
+
+SCUTEST(test_workspace_of_monitor, .iter = 2) {
+    addWorkspaces(3);
+    Monitor* m1 = addDummyMonitor();
+    Monitor* m2 = addFakeMonitor((Rect) {1, 1, 1, 1});
+    assignWorkspace(m1, getWorkspace(0));
+    assignWorkspace(m2, getWorkspace(1));
+    assertEquals(getWorkspaceOfMonitor(m1), getWorkspace(0));
+    assertEquals(getWorkspaceOfMonitor(m2), getWorkspace(1));
+    // swap with a visible and then an invisible workspace
+    swapMonitors(0, _i ? 1 : 2);
+    assertEquals(getWorkspaceOfMonitor(m1), getWorkspace(_i ? 1 : 2));
+    assertEquals(getWorkspaceOfMonitor(m2), getWorkspace(_i ? 0 : 1));
+    assertEquals(!!getMonitor(getWorkspace(0)), _i);
+    freeMonitor(m1);
+    assert(!getMonitor(getWorkspace(_i ? 1 : 2)));
+}
+
 SCUTEST_ITER(assign_workspace, 2) {
     addWorkspaces(2);
     Monitor* m = addDummyMonitor();
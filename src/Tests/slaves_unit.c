@@ -1,5 +1,6 @@
 #include <scutest/tester.h>
 #include "test-mpx-helper.h"
+#include "../masters.h"
 #include "../slaves.h"
 
 SCUTEST_SET_ENV(addDefaultMaster, simpleCleanup);
@@ -8,6 +9,22 @@ SCUTEST(slaves) {
     assert(getAllSlaves()->size);
     assert(getSlaveByName(""));
 }
+SCUTEST(lookup_by_device_id) {
+    Master* master = addFakeMaster(10, 11);
+    Slave* slave = newSlave(100, 10, 1, "");
+    Slave* slave2 = newSlave(MAX_DEVICE_ID + 1, 11, 0, "");
+    assertEquals(slave, getSlaveByID(100));
+    assertEquals(slave2, getSlaveByID(MAX_DEVICE_ID + 1));
+    assertEquals(master, getMasterByID(10));
+    assertEquals(master, getMasterByID(11));
+    assertEquals(master, getMasterForSlave(slave));
+    freeSlave(slave);
+    assert(!getSlaveByID(100));
+    freeMaster(master);
+    assert(!getMasterByID(10));
+    assert(!getMasterByID(11));
+    assert(getMasterByID(DEFAULT_KEYBOARD));
+}
 SCUTEST(detect_test_slaves) {
     const char* testDevices[] = {
         "XTEST pointer",
@@ -1,4 +1,6 @@
 #include <scutest/tester.h>
+#include <signal.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/resource.h>
@@ -48,11 +50,14 @@ SCUTEST(test_child_can_outlive_parent) {
     assertEquals(result, sizeof(buffer));
 }
 
-SCUTEST(test_no_zombies) {
+SCUTEST_ITER(test_no_zombies, 2) {
+    USE_POSIX_SPAWN = _i;
     for(int i = 0; i < 10; i++) {
         spawn("exit 0");
     }
     assertEquals(0, spawnAndWait("exit 0"));
+    while(getNumberOfDetachedChildren())
+        reapDetachedChildren();
     assertEquals(-1, waitpid(-1, NULL, WNOHANG));
 }
 
@@ -156,6 +161,56 @@ SCUTEST_ITER(spawn_env, 2) {
     assertEquals(waitForChild(pid), 0);
 }
 
+SCUTEST(spawn_env_without_fork) {
+    createSimpleEnv();
+    LD_PRELOAD_INJECTION = 1;
+    WindowInfo* winInfo = addFakeWindowInfo(1);
+    onWindowFocus(winInfo->id);
+    addFakeMonitor((Rect) {0, 0, 1, 1});
+    assignUnusedMonitorsToWorkspaces();
+    char command[255];
+    sprintf(command, "[ \"$_WIN_ID\" = %ud ] && [ -n \"$_ROOT_X\" ] && [ -n \"$LD_PRELOAD\" ]", winInfo->id);
+    assertEquals(0, spawnAndWait(command));
+    // the cached environment has to be rebuilt for the new master
+    setActiveMaster(newMaster(100, 101, "test"));
+    sprintf(command, "[ \"$%s\" = %ud ]", DEFAULT_KEYBOARD_ENV_VAR_NAME, getActiveMasterKeyboardID());
+    assertEquals(0, spawnAndWait(command));
+}
+
+SCUTEST_ITER(spawn_detached_signals_and_stdin, 2) {
+    USE_POSIX_SPAWN = _i;
+    int fds[2];
+    assert(!pipe(fds));
+    // not every shell can redirect to fds > 9
+    dup2(fds[1], 9);
+    close(fds[1]);
+    spawn("grep SigIgn /proc/$$/status >&9; readlink /proc/$$/fd/0 >&9; echo Session: $(cut -d' ' -f6 /proc/$$/stat) $$ >&9");
+    close(9);
+    char buffer[512] = {0};
+    int len = 0, result;
+    while((result = read(fds[0], buffer + len, sizeof(buffer) - 1 - len)) > 0)
+        len += result;
+    unsigned long long ignored;
+    assertEquals(1, sscanf(buffer, "SigIgn: %llx", &ignored));
+    assert(!(ignored & (1ULL << (SIGINT - 1) | 1ULL << (SIGQUIT - 1))));
+    char stdinPath[255] = {0};
+    assert(readlink("/proc/self/fd/0", stdinPath, sizeof(stdinPath) - 1) > 0);
+    assert(strstr(buffer, stdinPath));
+    int sid, pid;
+    assertEquals(2, sscanf(strstr(buffer, "Session:"), "Session: %d %d", &sid, &pid));
+    if(USE_POSIX_SPAWN)
+        assertEquals(sid, pid);
+}
+
+SCUTEST(spawn_env_detects_setenv) {
+    createSimpleEnv();
+    assertEquals(0, spawnAndWait("[ -z \"$MPX_TEST_VAR\" ]"));
+    setenv("MPX_TEST_VAR", "1", 1);
+    assertEquals(0, spawnAndWait("[ \"$MPX_TEST_VAR\" = 1 ]"));
+    unsetenv("MPX_TEST_VAR");
+    assertEquals(0, spawnAndWait("[ -z \"$MPX_TEST_VAR\" ]"));
+}
+
 SCUTEST(test_quit) {
     quit(0);
     assert(0);
@@ -103,3 +103,47 @@ SCUTEST(test_clear) {
     clearArray(&list);
     assert(list.size == 0);
 }
+
+SCUTEST(test_index_of_pointer) {
+    for(int i = 0; i < N; i++) {
+        int* n = newInt(0);
+        assert(-1 == getIndexOfPointer(&list, n));
+        addElement(&list, n);
+        assertEquals(i, getIndexOfPointer(&list, n));
+        // all elements compare equal by value
+        assertEquals(0, getIndex(&list, n, sizeof(int)));
+    }
+    int* last = peek(&list);
+    assertEquals(last, removeElementByPointer(&list, last));
+    assert(!removeElementByPointer(&list, last));
+    assertEquals(N - 1, list.size);
+    free(last);
+}
+
+SCUTEST(test_insert_remove_middle) {
+    for(int i = 0; i < N; i++)
+        addElement(&list, newInt(i));
+    int* n = newInt(-1);
+    addElementAt(&list, n, N / 2);
+    for(int i = 0; i <= N; i++)
+        assertEquals(i == N / 2 ? -1 : i - (i > N / 2), *(int*)getElement(&list, i));
+    assertEquals(n, removeIndex(&list, N / 2));
+    free(n);
+    for(int i = 0; i < N; i++)
+        assertEquals(i, *(int*)getElement(&list, i));
+}
+
+SCUTEST(test_shrink_on_remove) {
+    for(int i = 0; i < N * 10; i++)
+        addElement(&list, newInt(i));
+    int maxSize = list.maxSize;
+    while(list.size > 1)
+        free(pop(&list));
+    assert(list.maxSize < maxSize);
+    assert(list.maxSize >= list.size);
+    assertEquals(0, *(int*)getHead(&list));
+    for(int i = 1; i < N; i++)
+        addElement(&list, newInt(i));
+    for(int i = 0; i < N; i++)
+        assertEquals(i, *(int*)getElement(&list, i));
+}
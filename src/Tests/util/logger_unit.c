@@ -0,0 +1,175 @@
+#include "../../util/logger.h"
+#include "../tester.h"
+#include <scutest/tester.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int stdoutFD;
+static FILE* logFile;
+static LogLevel logLevel;
+static void redirectStdout() {
+    fflush(stdout);
+    logLevel = getLogLevel();
+    setLogLevel(LOG_LEVEL_VERBOSE);
+    stdoutFD = dup(STDOUT_FILENO);
+    logFile = tmpfile();
+    dup2(fileno(logFile), STDOUT_FILENO);
+}
+static void restoreStdout() {
+    stopAsyncLogging();
+    fflush(stdout);
+    dup2(stdoutFD, STDOUT_FILENO);
+    close(stdoutFD);
+    fclose(logFile);
+    setLogLevel(logLevel);
+}
+SCUTEST_SET_ENV(redirectStdout, restoreStdout);
+
+/**
+ * Reads back everything logged since the last call
+ *
+ * @param ids filled with the number of each "message %d" line in the order they were written
+ * @param dropNotices set to the number of lines reporting dropped messages
+ *
+ * @return the number of "message %d" lines
+ */
+static int readMessages(int* ids, int* dropNotices) {
+    fflush(stdout);
+    rewind(logFile);
+    char line[LOG_ENTRY_LEN * 2];
+    int n = 0;
+    *dropNotices = 0;
+    while(fgets(line, sizeof(line), logFile)) {
+        const char* message = strstr(line, "message ");
+        if(message)
+            ids[n++] = atoi(message + strlen("message "));
+        else if(strstr(line, "Dropped"))
+            (*dropNotices)++;
+    }
+    ftruncate(STDOUT_FILENO, 0);
+    rewind(logFile);
+    return n;
+}
+
+SCUTEST(test_async_logging_preserves_order) {
+    int ids[LOG_BUFFER_SIZE];
+    int dropNotices;
+    uint32_t drops = getNumberOfDroppedLogMessages();
+    startAsyncLogging();
+    assert(isAsyncLogging());
+    for(int i = 0; i < LOG_BUFFER_SIZE / 2; i++)
+        INFO("message %d", i);
+    stopAsyncLogging();
+    assert(!isAsyncLogging());
+    assertEquals(readMessages(ids, &dropNotices), LOG_BUFFER_SIZE / 2);
+    for(int i = 0; i < LOG_BUFFER_SIZE / 2; i++)
+        assertEquals(ids[i], i);
+    assertEquals(getNumberOfDroppedLogMessages(), drops);
+    assertEquals(dropNotices, 0);
+}
+
+SCUTEST(test_sync_logging_when_stopped) {
+    int id;
+    int dropNotices;
+    startAsyncLogging();
+    stopAsyncLogging();
+    INFO("message %d", 1);
+    assertEquals(readMessages(&id, &dropNotices), 1);
+    assertEquals(id, 1);
+}
+
+SCUTEST(test_async_logging_bounded_loss) {
+    static int ids[LOG_BUFFER_SIZE * 4];
+    int dropNotices;
+    uint32_t drops = getNumberOfDroppedLogMessages();
+    startAsyncLogging();
+    for(int i = 0; i < LEN(ids); i++)
+        DEBUG("message %d", i);
+    stopAsyncLogging();
+    int n = readMessages(ids, &dropNotices);
+    int dropped = getNumberOfDroppedLogMessages() - drops;
+    assertEquals(n + dropped, LEN(ids));
+    assertEquals(dropNotices > 0, dropped > 0);
+    for(int i = 1; i < n; i++)
+        assert(ids[i - 1] < ids[i]);
+}
+
+SCUTEST(test_async_logging_keeps_warnings) {
+    static int ids[LOG_BUFFER_SIZE * 4];
+    int dropNotices;
+    uint32_t drops = getNumberOfDroppedLogMessages();
+    startAsyncLogging();
+    for(int i = 0; i < LEN(ids); i++)
+        WARN("message %d", i);
+    stopAsyncLogging();
+    assertEquals(readMessages(ids, &dropNotices), LEN(ids));
+    assertEquals(getNumberOfDroppedLogMessages(), drops);
+}
+
+SCUTEST(test_async_logging_ignores_redirected_stdout) {
+    int id;
+    int dropNotices;
+    startAsyncLogging();
+    int fds[2];
+    assert(!pipe(fds));
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    int savedStdout = dup(STDOUT_FILENO);
+    dup2(fds[1], STDOUT_FILENO);
+    INFO("message %d", 1);
+    stopAsyncLogging();
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    close(fds[1]);
+    char buffer[LOG_ENTRY_LEN];
+    assert(read(fds[0], buffer, sizeof(buffer)) <= 0);
+    close(fds[0]);
+    assertEquals(readMessages(&id, &dropNotices), 1);
+    assertEquals(id, 1);
+}
+
+static void writeQueuedLogMessagesOnSignal(int sig) {
+    writeQueuedLogMessagesFromSignal();
+}
+SCUTEST(test_write_queued_messages_from_signal) {
+    static int ids[LOG_BUFFER_SIZE * 4];
+    int dropNotices;
+    bool seen[LOG_BUFFER_SIZE / 2] = {0};
+    startAsyncLogging();
+    for(int i = 0; i < LEN(seen); i++)
+        INFO("message %d", i);
+    signal(SIGUSR1, writeQueuedLogMessagesOnSignal);
+    raise(SIGUSR1);
+    signal(SIGUSR1, SIG_DFL);
+    assert(!isAsyncLogging());
+    stopAsyncLogging();
+    // messages are split between the signal handler and the logging thread but each is written once
+    assertEquals(readMessages(ids, &dropNotices), LEN(seen));
+    for(int i = 0; i < LEN(seen); i++) {
+        assert(!seen[ids[i]]);
+        seen[ids[i]] = 1;
+    }
+}
+
+SCUTEST(test_context_depth) {
+    char buffer[LOG_ENTRY_LEN * 2];
+    pushContext("A");
+    pushContext("B");
+    formatContextStr(buffer, sizeof(buffer));
+    assert(strstr(buffer, "[A][B]"));
+    for(int i = 0; i < MAX_LOG_CONTEXT_DEPTH; i++)
+        pushContext("C");
+    formatContextStr(buffer, sizeof(buffer));
+    assert(strstr(buffer, "[C][...]"));
+    for(int i = 0; i < MAX_LOG_CONTEXT_DEPTH; i++)
+        popContext();
+    formatContextStr(buffer, sizeof(buffer));
+    assert(strstr(buffer, "[A][B]"));
+    assert(!strstr(buffer, "[C]"));
+    popContext();
+    popContext();
+    formatContextStr(buffer, sizeof(buffer));
+    assert(!strchr(buffer, '['));
+}
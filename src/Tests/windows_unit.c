@@ -56,6 +56,22 @@ SCUTEST(dock_properties_clear) {
     setDockProperties(winInfo, NULL, 0);
     assert(!getDockProperties(winInfo));
 }
+SCUTEST(test_transient_index) {
+    WindowInfo* parent = addFakeWindowInfo(1);
+    WindowInfo* dialog = addFakeWindowInfo(2);
+    WindowInfo* dialog2 = addFakeWindowInfo(3);
+    assertEquals(0, getTransientsOf(parent->id)->size);
+    setTransientFor(dialog, parent->id);
+    setTransientFor(dialog2, parent->id);
+    assertEquals(2, getTransientsOf(parent->id)->size);
+    setTransientFor(dialog2, dialog->id);
+    assertEquals(1, getTransientsOf(parent->id)->size);
+    assertEquals(dialog2, getHead(getTransientsOf(dialog->id)));
+    freeWindowInfo(dialog2);
+    assertEquals(0, getTransientsOf(dialog->id)->size);
+    setTransientFor(dialog, 0);
+    assertEquals(0, getTransientsOf(parent->id)->size);
+}
 SCUTEST(test_enable_tilingoverride) {
     WindowInfo* winInfo = addFakeWindowInfo(1);
     int len = 5;
@@ -6,7 +6,10 @@
 #include "test-wm-helper.h"
 #include "../wm-rules.h"
 #include "../layouts.h"
+#include "../util/latency-probe.h"
+#include "../util/request-stats.h"
 #include "../wmfunctions.h"
+#include "../xutil/window-properties.h"
 #include "../layouts.h"
 
 static void setupEnvWithBasicRules() {
@@ -141,6 +144,125 @@ SCUTEST(test_switching_workspaces) {
     assert(isWindowMapped(win));
     assert(!isWindowMapped(win2));
 }
+SCUTEST(test_lazy_window_string_properties) {
+    WindowID win = createNormalWindow();
+    setWindowClass(win, "class", "instance");
+    setWindowTitle(win, "title");
+    registerWindow(win, root, NULL);
+    WindowInfo* winInfo = getWindowInfo(win);
+    loadWindowProperties(winInfo);
+    assertEquals(0, winInfo->loadedStringProperties);
+    assert(strcmp(getTitle(winInfo), "title") == 0);
+    assertEquals(WINDOW_TITLE_PROPERTY, winInfo->loadedStringProperties);
+    assert(strcmp(getClassName(winInfo), "class") == 0);
+    assert(strcmp(getInstanceName(winInfo), "instance") == 0);
+    assertEquals(WINDOW_TITLE_PROPERTY | WINDOW_CLASS_PROPERTY, winInfo->loadedStringProperties);
+}
+SCUTEST(test_type_name_without_type) {
+    WindowID win = createNormalWindow();
+    registerWindow(win, root, NULL);
+    WindowInfo* winInfo = getWindowInfo(win);
+    winInfo->type = 0;
+    markWindowStringPropertiesStale(winInfo, ALL_WINDOW_STRING_PROPERTIES);
+    assertEquals(0, getTypeName(winInfo)[0]);
+    assertEquals(WINDOW_TYPE_NAME_PROPERTY, winInfo->loadedStringProperties);
+    // the name is reloaded once the type is known
+    loadWindowProperties(winInfo);
+    assert(strcmp(getTypeName(winInfo), "_NET_WM_WINDOW_TYPE_NORMAL") == 0);
+}
+SCUTEST(test_prefetch_window_string_properties) {
+    addWindowStringPropertiesPrefetchHint(WINDOW_CLASS_PROPERTY | WINDOW_ROLE_PROPERTY);
+    WindowID win = createNormalWindow();
+    setWindowRole(win, "role");
+    registerWindow(win, root, NULL);
+    WindowInfo* winInfo = getWindowInfo(win);
+    loadWindowProperties(winInfo);
+    assertEquals(WINDOW_CLASS_PROPERTY | WINDOW_ROLE_PROPERTY, winInfo->loadedStringProperties);
+    assert(strcmp(winInfo->role, "role") == 0);
+}
+SCUTEST(test_debounced_title_refresh) {
+    TITLE_REFRESH_INTERVAL = 50;
+    addEvent(WINDOW_TITLE_CHANGE, DEFAULT_EVENT(incrementCount));
+    WindowID untracked = createNormalWindow();
+    WindowID win = createNormalWindow();
+    setWindowTitle(win, "title");
+    registerWindow(untracked, root, NULL);
+    registerWindow(win, root, NULL);
+    WindowInfo* winInfo = getWindowInfo(win);
+    assert(strcmp(getTitle(winInfo), "title") == 0);
+    char title[16];
+    for(int i = 0; i < 10; i++) {
+        sprintf(title, "title%d", i);
+        setWindowTitle(win, title);
+        setWindowTitle(untracked, title);
+    }
+    runEventLoop();
+    WAIT_UNTIL_TRUE(!getNumberOfPendingTitleRefreshes(), runEventLoop());
+    assert(strcmp(getTitle(winInfo), title) == 0);
+    assert(getCount() >= 1 && getCount() <= 2);
+    assertEquals(0, getWindowInfo(untracked)->loadedStringProperties);
+}
+static void roundTripRule() {
+    XCALL(xcb_map_window, dis, root);
+    catchError(xcb_map_window_checked(dis, root));
+}
+SCUTEST(test_request_stats) {
+    resetRequestStats();
+    addEvent(WINDOW_TITLE_CHANGE, DEFAULT_EVENT(roundTripRule));
+    applyEventRules(WINDOW_TITLE_CHANGE, NULL);
+    const RequestStats* stats = getRequestStatsOfRule("_roundTripRule");
+    assert(stats);
+    assertEquals(1, stats->requests);
+    assertEquals(1, stats->roundTrips);
+    assertEquals(1, getRequestStatsOfEvent(WINDOW_TITLE_CHANGE)->roundTrips);
+    assert(getTotalRequestStats()->requests >= 1);
+}
+SCUTEST(test_hot_paths_have_no_round_trips) {
+    WindowID win = mapWindow(createNormalWindow());
+    WindowID parent = mapWindow(createNormalWindow());
+    runEventLoop();
+    // titles are only tracked once they have been loaded
+    getTitle(getWindowInfo(win));
+    enableHotPathAssertions(1);
+    setWindowPosition(win, (Rect) {1, 2, 3, 4});
+    setWindowTitle(win, "title");
+    xcb_icccm_wm_hints_t hints = {.input = 1};
+    xcb_icccm_wm_hints_set_urgency(&hints);
+    xcb_icccm_set_wm_hints(dis, win, &hints);
+    xcb_icccm_set_wm_transient_for(dis, win, parent);
+    runEventLoop();
+    WAIT_UNTIL_TRUE(hasMask(getWindowInfo(win), URGENT_MASK) && getWindowInfo(win)->transientFor == parent,
+        runEventLoop());
+    enableHotPathAssertions(0);
+}
+SCUTEST_ERR(test_hot_path_round_trip_assertion, SIGABRT) {
+    suppressOutput();
+    setHotPath(WINDOW_TITLE_CHANGE, 1);
+    enableHotPathAssertions(1);
+    addEvent(WINDOW_TITLE_CHANGE, DEFAULT_EVENT(roundTripRule));
+    applyEventRules(WINDOW_TITLE_CHANGE, NULL);
+}
+static void setupEnvWithoutIdleShutdown() {
+    registerDefaultLayouts();
+    addBasicRules();
+    addWorkspaces(1);
+    openXDisplay();
+}
+SCUTEST_SET_ENV(setupEnvWithoutIdleShutdown, cleanupXServer);
+SCUTEST(test_title_refresh_without_other_events) {
+    addEvent(WINDOW_TITLE_CHANGE, DEFAULT_EVENT(requestShutdown));
+    WindowID win = createNormalWindow();
+    setWindowTitle(win, "title");
+    registerWindow(win, root, NULL);
+    assert(strcmp(getTitle(getWindowInfo(win)), "title") == 0);
+    setWindowTitle(win, "title2");
+    // the event loop would otherwise block forever if nothing wakes it up to read the replies
+    alarm(5);
+    runEventLoop();
+    alarm(0);
+    assert(strcmp(getTitle(getWindowInfo(win)), "title2") == 0);
+}
+
 static void setupEnvWithAutoTileRules() {
     addAutoTileRules();
     setupEnvWithBasicRules();
@@ -175,9 +297,14 @@ SCUTEST(test_auto_tile, .iter = 4) {
     runEventLoop();
     assertEquals(2, getCount());
 }
+static WindowID probeWindow;
+static void moveProbeWindow() {
+    setWindowPosition(probeWindow, (Rect) {0, 0, 10, 10});
+}
 static Binding bindings[] = {
     {0, 1, {incrementCount}},
-    {0, XK_A, {incrementCount}}
+    {0, XK_A, {incrementCount}},
+    {0, XK_B, {moveProbeWindow}},
 };
 static void setupEnvWithBasicRulesAndBindings() {
     addBindings(bindings, LEN(bindings));
@@ -194,6 +321,29 @@ SCUTEST(test_trigger_key_binding) {
     runEventLoop();
     assertEquals(1, getCount());
 }
+SCUTEST(test_latency_probe) {
+    enableLatencyProbe(1);
+    probeWindow = mapArbitraryWindow();
+    runEventLoop();
+    // bindings that don't configure or focus a window aren't measured
+    typeKey(getKeyCode(XK_A), getActiveMasterKeyboardID());
+    runEventLoop();
+    assertEquals(1, getCount());
+    assertEquals(0, getNumberOfLatencySamples());
+    for(int i = 1; i <= 3; i++) {
+        typeKey(getKeyCode(XK_B), getActiveMasterKeyboardID());
+        runEventLoop();
+        assertEquals(i, getNumberOfLatencySamples());
+    }
+    uint32_t total = 0;
+    for(int i = 0; i < LATENCY_HISTOGRAM_SIZE; i++)
+        total += getLatencyHistogramCount(i);
+    assertEquals(3, total);
+    enableLatencyProbe(0);
+    typeKey(getKeyCode(XK_B), getActiveMasterKeyboardID());
+    runEventLoop();
+    assertEquals(3, getNumberOfLatencySamples());
+}
 
 static void setupClientEnvWithBasicRules() {
     createSigAction(SIGCHLD, requestShutdown);
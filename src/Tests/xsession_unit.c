@@ -76,7 +76,9 @@ SCUTEST(reopen_display) {
 }
 
 SCUTEST(create_destroy_window) {
-    assert(!destroyWindow(createNormalWindow()));
+    WindowID win = createNormalWindow();
+    destroyWindow(win);
+    assert(!xcb_get_window_attributes_reply(dis, xcb_get_window_attributes(dis, win), NULL));
 }
 
 SCUTEST(attemptToMapWindow) {
@@ -133,6 +135,34 @@ SCUTEST_ITER_ERR(crash_on_error, 2, 1) {
     else
         assert(catchError(xcb_map_window_checked(dis, 0)) == BadWindow);
 }
+static int trackedErrorCode;
+static void recordTrackedError(xcb_generic_error_t* e) {
+    trackedErrorCode = e->error_code;
+}
+SCUTEST(track_request_errors) {
+    WindowID win = createNormalWindow();
+    trackRequest(xcb_map_window(dis, win), "good map", recordTrackedError);
+    trackRequest(xcb_map_window(dis, 0), "bad map", recordTrackedError);
+    flush();
+    xcb_generic_event_t* e;
+    while((e = xcb_wait_for_event(dis)) && e->response_type)
+        free(e);
+    assert(e);
+    assert(strcmp(getCallSiteOfError((xcb_generic_error_t*)e), "bad map") == 0);
+    handleXError((xcb_generic_error_t*)e);
+    assertEquals(trackedErrorCode, BadWindow);
+    free(e);
+}
+SCUTEST(track_request_ignores_stale_sequence) {
+    const uint32_t sequence = 10;
+    xcb_generic_error_t e = {.sequence = sequence, .full_sequence = sequence + (1 << 16)};
+    trackRequest((xcb_void_cookie_t) {sequence}, "stale", NULL);
+    assert(!getCallSiteOfError(&e));
+    trackRequest((xcb_void_cookie_t) {sequence + (1 << 16)}, "current", NULL);
+    assert(strcmp(getCallSiteOfError(&e), "current") == 0);
+    e.full_sequence = sequence;
+    assert(!getCallSiteOfError(&e));
+}
 SCUTEST(load_unknown_generic_events) {
     xcb_ge_generic_event_t event = {0};
     assert(loadGenericEvent(&event) == 0);
@@ -179,7 +209,7 @@ SCUTEST(test_event_spam) {
     startWM();
     while(!isShuttingDown()) {
         lock();
-        assert(!destroyWindow(createNormalWindow()));
+        destroyWindow(createNormalWindow());
         flush();
         unlock();
     }
@@ -8,6 +8,7 @@
 #include "bindings.h"
 #include "globals.h"
 #include "masters.h"
+#include "util/latency-probe.h"
 #include "util/logger.h"
 #include "windows.h"
 #include "xutil/device-grab.h"
@@ -103,6 +104,7 @@ bool checkBindings(const BindingEvent* event) {
         if(matches(binding, event)) {
             TRACE("Found match");
             LOG_RUN(LOG_LEVEL_TRACE, dumbBinding(binding));
+            armLatencyProbe(event->arrivalTime);
             callBindingWithWindow(&binding->func, binding->flags.windowToPass, event);
             if(binding->flags.popChain) {
                 assert(masterBindings->size);
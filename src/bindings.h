@@ -87,6 +87,8 @@ typedef struct BindingEvent {
     bool keyRepeat;
     /// the window the binding was triggered on
     WindowInfo* winInfo;
+    /// when the event arrived (µs); 0 unless the latency probe is enabled
+    uint64_t arrivalTime;
 } BindingEvent;
 
 
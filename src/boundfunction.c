@@ -4,6 +4,7 @@
 #include "util/arraylist.h"
 #include "util/debug.h"
 #include "util/logger.h"
+#include "util/request-stats.h"
 #include <stdlib.h>
 
 /// Holds batch events
@@ -56,12 +57,14 @@ static bool applyRules(ArrayList* rules, void* p) {
     INFO("Attempting to apply %d rules", rules->size);
     FOR_EACH(BoundFunction*, func, rules) {
         DEBUG("Running func: %s %p", func->name, p);
+        const char* lastRule = setRequestStatsRule(func->name);
         pushContext(func->name);
         int abort = 0;
         if(func->intFunc)
             abort = !func->func.intFunc(p, func->arg) && func->abort;
         else
             func->func.func(p, func->arg);
+        setRequestStatsRule(lastRule);
         popContext();
         if(abort) {
             INFO("Rules aborted early due to: %s", func->name);
@@ -93,7 +96,9 @@ void applyBatchEventRules(void) {
 bool applyEventRules(UserEvent type, void* p) {
     incrementBatchEventRuleCounter(type);
     pushContext(eventTypeToString(type));
+    pushRequestStatsEvent(type);
     bool result = applyRules(&eventRules[type], p);
+    popRequestStatsEvent();
     popContext();
     return result;
 }
@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -13,6 +14,9 @@
 #include "layouts.h"
 #include "system.h"
 #include "util/debug.h"
+#include "util/ipc-socket.h"
+#include "util/latency-probe.h"
+#include "util/request-stats.h"
 #include "util/logger.h"
 #include "windows.h"
 #include "wmfunctions.h"
@@ -70,8 +74,12 @@ static Option baseOptions[] = {
     {"dump", {dumpWindowFilter, .arg.i = MAPPABLE_MASK}, .flags = FORK_ON_RECEIVE},
     {"dump-master", {dumpMaster, .arg.i = 0}, .flags = FORK_ON_RECEIVE},
     {"dump-rules", {dumpRules},  .flags = FORK_ON_RECEIVE},
+    {"dump-latency", {printLatencyHistogram}, .flags = FORK_ON_RECEIVE},
     {"dump-win", {dumpWindow},  .flags = FORK_ON_RECEIVE | REQUEST_INT},
+    {"dump-x-stats", {printRequestStats}, .flags = FORK_ON_RECEIVE},
     {"focus-win", {(void(*)())focusWindow}, .flags = REQUEST_INT},
+    {"hot-path-assertions", {(void(*)())enableHotPathAssertions}, .flags = REQUEST_INT},
+    {"latency-probe", {(void(*)())enableLatencyProbe}, .flags = REQUEST_INT},
     {"log-level", {setLogLevel}, .flags = VAR_SETTER | REQUEST_INT},
     {"lower", {lowerWindow}, .flags = REQUEST_INT},
     {"next-layout", {cycleLayouts}, UP},
@@ -85,7 +93,9 @@ static Option baseOptions[] = {
     {"raise-or-run", {raiseOrRun},  .flags = REQUEST_STR | UNSAFE},
     {"raise-or-run-role", {raiseOrRunRole},  .flags = REQUEST_STR | REQUEST_MULTI | UNSAFE},
     {"raise-or-run-title", {raiseOrRunTitle},  .flags = REQUEST_STR | REQUEST_MULTI | UNSAFE},
+    {"reset-x-stats", {resetRequestStats}},
     {"restart", {restart}, .flags = CONFIRM_EARLY},
+    {"retile", {retile}},
     {"spawn", {spawn},  .flags = REQUEST_STR | UNSAFE},
     {"quit", {requestShutdown},  .flags = UNSAFE},
     {"sum", {printSummary}, .flags = FORK_ON_RECEIVE},
@@ -103,6 +113,7 @@ void initOptions() {
 }
 void addInterClientCommunicationRule() {
     addEvent(XCB_CLIENT_MESSAGE, DEFAULT_EVENT(receiveClientMessage));
+    addEvent(X_CONNECTION, DEFAULT_EVENT(listenForIPCSocketRequests));
 }
 
 
@@ -157,6 +168,112 @@ const Option* findOption(const char* name, const char* value1, const char* value
     return NULL;
 }
 
+/// Where a request came from and how to respond to it
+typedef struct {
+    /// the window a request sent over X came from
+    WindowID win;
+    /// pid of the owner of win; used to find the caller's stdout
+    pid_t pid;
+    /// the connection a socket request came in on or -1
+    int sock;
+    /// the caller's stdout if it was passed over the socket or -1
+    int outputFD;
+    /// the exit code of each command of a socket request
+    int* statuses;
+    /// number of commands in a socket request
+    uint32_t numCommands;
+    /// index of the command being processed
+    uint32_t current;
+    /// set once a response has been sent
+    bool responded;
+} IPCSender;
+
+static void sendResponse(IPCSender* sender, int exitCode) {
+    sender->responded = 1;
+    if(sender->sock != -1) {
+        sender->statuses[sender->current] = exitCode;
+        sendIPCSocketResponse(sender->sock, sender->statuses, sender->numCommands);
+    }
+    else
+        sendConfirmation(sender->win, exitCode);
+}
+
+/**
+ * @return a new fd referring to the caller's stdout or -1
+ */
+static int openSenderOutput(const IPCSender* sender) {
+    if(sender->outputFD != -1)
+        return dup(sender->outputFD);
+    char outputFile[64] = {"/dev/null"};
+    if(sender->pid) {
+        const char* formatter = "/proc/%d/fd/1";
+        sprintf(outputFile, formatter, sender->pid);
+    }
+    int fd = open(outputFile, O_WRONLY | O_APPEND);
+    if(fd == -1)
+        WARN("could not open %s for writing;", outputFile);
+    return fd;
+}
+
+/**
+ * Runs the option matching name, value and value2
+ *
+ * @return the exit code of the option
+ */
+static int processRequest(IPCSender* sender, WindowID active, const char* name, const char* value,
+    const char* value2) {
+    DEBUG("Received option %s values %s %s", name, value, value2);
+    const Option* option = findOption(name, value, value2);
+    if(active) {
+        WindowInfo* winInfo = getWindowInfo(active);
+        if(winInfo) {
+            INFO("Find client master for %d", winInfo->id);
+            setActiveMasterByDeviceID(getClientPointerForWindow(winInfo->id));
+        }
+        else {
+            INFO("Setting active master to %d", active);
+            setActiveMasterByDeviceID(active);
+        }
+    }
+    if(option && (ALLOW_UNSAFE_OPTIONS || !(option->flags & UNSAFE))) {
+        INFO("Executing %s", option->name);
+        int returnValue = 0;
+        if(option->flags & CONFIRM_EARLY) {
+            TRACE("sending early confirmation");
+            destroyWindow(getPrivateWindow());
+            sendResponse(sender, NORMAL_TERMINATION);
+            flush();
+        }
+        fflush(NULL);
+        int savedStdout = -1;
+        if((option->flags & FORK_ON_RECEIVE)) {
+            int fd = openSenderOutput(sender);
+            if(fd != -1) {
+                savedStdout = dup(STDOUT_FILENO);
+                if(dup2(fd, STDOUT_FILENO) == -1) {
+                    WARN("could not redirect output; could not call/set '%s' aborting", option->name);
+                    exit(SYS_CALL_FAILED);
+                }
+                close(fd);
+            }
+        }
+        callOption(option, value, value2);
+        if(savedStdout != -1) {
+            fflush(NULL);
+            if(dup2(savedStdout, STDOUT_FILENO) == -1) {
+                perror("Could not revert back stdout");
+            }
+            close(savedStdout);
+        }
+        return returnValue;
+    }
+    if(option)
+        INFO("option '%s' is unsafe and unsafe options are not allowed", name);
+    else
+        WARN("could not find option matching '%s' '%s' '%s'", name, value, value2);
+    return INVALID_OPTION;
+}
+
 void receiveClientMessage(xcb_client_message_event_t* event) {
     xcb_client_message_data_t data = event->data;
     WindowID win = event->window;
@@ -168,68 +285,90 @@ void receiveClientMessage(xcb_client_message_event_t* event) {
     getWindowPropertyString(win, OPTION_NAME, ewmh->UTF8_STRING, name);
     getWindowPropertyStrings(win, OPTION_VALUES, ewmh->UTF8_STRING, values, LEN(values));
     if(message == MPX_WM_INTERPROCESS_COM && name[0]) {
-        DEBUG("Received option %s values %s %s", name, values[0], values[1]);
-        pid_t callerPID = getWindowPropertyValueInt(win, ewmh->_NET_WM_PID, XCB_ATOM_CARDINAL);
-        const Option* option = findOption(name, values[0], values[1]);
-        if(active) {
-            WindowInfo* winInfo = getWindowInfo(active);
-            if(winInfo) {
-                INFO("Find client master for %d", winInfo->id);
-                setActiveMasterByDeviceID(getClientPointerForWindow(winInfo->id));
-            }
-            else {
-                INFO("Setting active master to %d", active);
-                setActiveMasterByDeviceID(active);
-            }
-        }
-        if(option && (ALLOW_UNSAFE_OPTIONS || !(option->flags & UNSAFE))) {
-            INFO("Executing %s", option->name);
-            int returnValue = 0;
-            if(option->flags & CONFIRM_EARLY) {
-                TRACE("sending early confirmation");
-                destroyWindow(getPrivateWindow());
-                sendConfirmation(win, NORMAL_TERMINATION);
-                flush();
-            }
-            fflush(NULL);
-            int stdout = -1;
-            if((option->flags & FORK_ON_RECEIVE)) {
-                fflush(NULL);
-                stdout = dup(STDOUT_FILENO);
-                char outputFile[64] = {"/dev/null"};
-                if(callerPID) {
-                    const char* formatter = "/proc/%d/fd/1";
-                    sprintf(outputFile, formatter, callerPID);
-                }
-                int fd = open(outputFile, O_WRONLY | O_APPEND);
-                if(fd == -1) {
-                    WARN("could not open %s for writing;", outputFile);
-                }
-                else if(dup2(fd, STDOUT_FILENO) == -1) {
-                    WARN("could not open %s for writing; could not call/set '%s' aborting", outputFile,
-                        option->name);
-                    exit(SYS_CALL_FAILED);
-                }
-                else
-                    close(fd);
-            }
-            callOption(option, values[0], values[1]);
-            if((option->flags & FORK_ON_RECEIVE)) {
-                fflush(NULL);
-                if(dup2(stdout, STDOUT_FILENO) == -1) {
-                    perror("Could not revert back stdout");
-                }
-                close(stdout);
-            }
-            if(!(option->flags & CONFIRM_EARLY))
-                sendConfirmation(win, returnValue);
-        }
-        else {
-            if(option)
-                INFO("option '%s' is unsafe and unsafe options are not allowed", name);
-            else
-                WARN("could not find option matching '%s' '%s' '%s'", name, values[0], values[1]);
-            sendConfirmation(win, INVALID_OPTION);
-        }
+        IPCSender sender = {
+            .win = win,
+            .pid = getWindowPropertyValueInt(win, ewmh->_NET_WM_PID, XCB_ATOM_CARDINAL),
+            .sock = -1,
+            .outputFD = -1
+        };
+        int status = processRequest(&sender, active, name, values[0], values[1]);
+        if(!sender.responded)
+            sendResponse(&sender, status);
+    }
+}
+
+static int ipcSocketFD = -1;
+/// connections that haven't sent their full request yet; ordered from oldest to newest
+static ArrayList pendingIPCConnections;
+
+static void runIPCSocketRequest(int client, IPCRequest* request) {
+    int statuses[request->numCommands];
+    for(int i = 0; i < request->numCommands; i++)
+        statuses[i] = WM_NOT_RESPONDING;
+    IPCSender sender = {.sock = client, .outputFD = request->outputFD, .statuses = statuses, .numCommands = request->numCommands};
+    setTilingDeferred(1);
+    for(; sender.current < request->numCommands; sender.current++) {
+        const IPCCommand* command = &request->commands[sender.current];
+        statuses[sender.current] = processRequest(&sender, request->active, command->name, command->value, command->value2);
     }
+    setTilingDeferred(0);
+    retileAllDirtyWorkspaces();
+    if(!sender.responded)
+        sendIPCSocketResponse(client, statuses, request->numCommands);
+}
+
+/**
+ * Reads what is available of the request of connection and runs it once complete
+ *
+ * @return 1 iff connection is done and should be closed
+ */
+static bool readIPCConnection(IPCConnection* connection) {
+    int result = readIPCSocketRequest(connection);
+    if(result == 1)
+        runIPCSocketRequest(connection->fd, &connection->request);
+    return result != 0;
+}
+static void freeIPCConnection(IPCConnection* connection) {
+    closeIPCSocketRequest(connection->fd, &connection->request);
+    free(connection);
+}
+static void closeIPCConnection(IPCConnection* connection) {
+    removeElementByPointer(&pendingIPCConnections, connection);
+    removeExtraEvent(connection->fd);
+    freeIPCConnection(connection);
+}
+
+static void onIPCSocketData(int fd) {
+    IPCConnection* connection = findElement(&pendingIPCConnections, &fd, sizeof(int));
+    if(connection && readIPCConnection(connection))
+        closeIPCConnection(connection);
+}
+
+static void onIPCSocketConnection(int fd) {
+    int client = acceptIPCSocketConnection(fd);
+    if(client == -1)
+        return;
+    IPCConnection* connection = malloc(sizeof(IPCConnection));
+    *connection = (IPCConnection) {.fd = client, .request = {.outputFD = -1}};
+    // the request has usually already been sent by the time the connection is accepted
+    if(readIPCConnection(connection)) {
+        freeIPCConnection(connection);
+        return;
+    }
+    if(pendingIPCConnections.size >= IPC_MAX_PENDING_CONNECTIONS) {
+        WARN("Too many pending ipc connections; dropping the oldest");
+        closeIPCConnection(getHead(&pendingIPCConnections));
+    }
+    addElement(&pendingIPCConnections, connection);
+    // POLLHUP is requested so the connection is closed by onIPCSocketData instead of being silently dropped by the
+    // event loop
+    addExtraEvent(client, POLLIN | POLLHUP, onIPCSocketData);
+}
+
+void listenForIPCSocketRequests(void) {
+    if(!IPC_USE_SOCKET || ipcSocketFD != -1)
+        return;
+    ipcSocketFD = createIPCSocket();
+    if(ipcSocketFD != -1)
+        addExtraEvent(ipcSocketFD, POLLIN, onIPCSocketConnection);
 }
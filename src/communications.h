@@ -71,6 +71,12 @@ void receiveClientMessage(xcb_client_message_event_t* event);
 void send(const char* name, const char* value);
 void sendAs(const char* name, WindowID active, const char* value, const char* value2);
 
+/**
+ * Listens for requests on the socket at getIPCSocketPath() and handles them in the event loop.
+ * Requests are matched against the same options as those sent with send().
+ * Does nothing if IPC_USE_SOCKET is not set
+ */
+void listenForIPCSocketRequests(void);
 
 /**
  * @return 1 iff there are send messages whose receipt has not been confirmed
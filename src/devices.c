@@ -1,7 +1,6 @@
 #include <assert.h>
 #include <string.h>
 
-#include <X11/extensions/XInput2.h>
 #include <xcb/xinput.h>
 #ifndef NO_XRANDR
 #include <xcb/randr.h>
@@ -22,10 +21,26 @@
 
 #pragma GCC diagnostic ignored "-Wnarrowing"
 
+/**
+ * Sends a single change to the device hierarchy
+ *
+ * @param change one of the xcb_input_*_master_t or xcb_input_*_slave_t structs with type and len set
+ */
+static void changeHierarchy(const void* change) {
+    XCALL(xcb_input_xi_change_hierarchy, dis, 1, (const xcb_input_hierarchy_change_t*)change);
+}
 void createMasterDevice(const char* name) {
-    XIAddMasterInfo add = {.type = XIAddMaster, .name = (char*)name, .send_core = 1, .enable = 1};
-    XIChangeHierarchy(dpy, (XIAnyHierarchyChangeInfo*)&add, 1);
-    //xcb_input_xi_change_hierarchy(c, num_changes, changes);
+    uint16_t nameLen = strlen(name);
+    // the name immediately follows the struct and is padded to a multiple of 4
+    uint16_t size = sizeof(xcb_input_add_master_t) + ((nameLen + 3) & ~3);
+    char buffer[size];
+    memset(buffer, 0, size);
+    *(xcb_input_add_master_t*)buffer = (xcb_input_add_master_t) {
+        .type = XCB_INPUT_HIERARCHY_CHANGE_TYPE_ADD_MASTER, .len = size / 4, .name_len = nameLen,
+        .send_core = 1, .enable = 1
+    };
+    memcpy(buffer + sizeof(xcb_input_add_master_t), name, nameLen);
+    changeHierarchy(buffer);
 }
 void attachSlaveToMaster(Slave* slave, Master* master) {
     assert(!isTestDevice(slave->name));
@@ -35,29 +50,29 @@ void attachSlaveToMaster(Slave* slave, Master* master) {
 }
 void floatSlave(SlaveID slaveID) {
     INFO("floating %d ", slaveID);
-    XIAnyHierarchyChangeInfo changes;
-    changes.type = XIDetachSlave;
-    changes.attach.deviceid = slaveID;
-    XIChangeHierarchy(dpy, &changes, 1);
+    xcb_input_detach_slave_t change = {.type = XCB_INPUT_HIERARCHY_CHANGE_TYPE_DETACH_SLAVE,
+                                       .len = sizeof(change) / 4, .deviceid = slaveID
+                                      };
+    changeHierarchy(&change);
 }
 void attachSlaveToMasterDevice(SlaveID slaveID, MasterID masterID) {
     INFO("attaching %d to %d", slaveID, masterID);
-    XIAnyHierarchyChangeInfo changes;
-    changes.type = XIAttachSlave;
-    changes.attach.deviceid = slaveID;
-    changes.attach.new_master = masterID;
-    XIChangeHierarchy(dpy, &changes, 1);
+    xcb_input_attach_slave_t change = {.type = XCB_INPUT_HIERARCHY_CHANGE_TYPE_ATTACH_SLAVE,
+                                       .len = sizeof(change) / 4, .deviceid = slaveID, .master = masterID
+                                      };
+    changeHierarchy(&change);
 }
 void destroyMasterDevice2(MasterID id, int returnPointer, int returnKeyboard) {
     assert(id != DEFAULT_KEYBOARD && id != DEFAULT_POINTER);
-    XIRemoveMasterInfo remove = {
-        .type = XIRemoveMaster,
+    xcb_input_remove_master_t remove = {
+        .type = XCB_INPUT_HIERARCHY_CHANGE_TYPE_REMOVE_MASTER,
+        .len = sizeof(remove) / 4,
         .deviceid = id,
-        .return_mode = XIAttachToMaster,
+        .return_mode = XCB_INPUT_CHANGE_MODE_ATTACH,
         .return_pointer = returnPointer,
         .return_keyboard = returnKeyboard,
     };
-    XIChangeHierarchy(dpy, (XIAnyHierarchyChangeInfo*)&remove, 1);
+    changeHierarchy(&remove);
 }
 
 void destroyAllNonDefaultMasters(void) {
@@ -68,67 +83,62 @@ void destroyAllNonDefaultMasters(void) {
 }
 
 void registerMasterDevice(MasterID id) {
-    /*
-    xcb_input_xi_query_device_cookie_t cookie=xcb_input_xi_query_device(dis, XIAllMasterDevices);
-    xcb_input_xi_query_device_reply_t *reply=xcb_input_xi_query_device_reply(dis, cookie, NULL);
-
-    xcb_input_xi_device_info_iterator_t *iter= xcb_input_xi_query_device_infos_iterator(reply);
-
-    while(iter->rem){
-        xcb_input_xi_device_info_t info=iter->data;
-        xcb_input_xi_device_info_next(iter);
-        xcb_input_xi_device_it
-        xcb_input_xi_iter_n
-        xcb_randr_monitor_info_next
-        //detectMonitors()
-    }*/
-    //xcb_input_xi_query_device(c, deviceid);
-    int ndevices;
-    XIDeviceInfo* devices, *device;
-    devices = XIQueryDevice(dpy, id, &ndevices);
-    DEBUG("Detected %d devices", ndevices);
-    for(int i = 0; i < ndevices; i++) {
-        device = &devices[i];
-        switch(device->use) {
-            case XIMasterPointer:
+    xcb_input_xi_query_device_reply_t* reply = xcb_input_xi_query_device_reply(dis,
+            xcb_input_xi_query_device(dis, id), NULL);
+    if(!reply) {
+        WARN("Could not query device %d", id);
+        return;
+    }
+    DEBUG("Detected %d devices", reply->num_infos);
+    char name[MAX_NAME_LEN];
+    xcb_input_xi_device_info_iterator_t iter = xcb_input_xi_query_device_infos_iterator(reply);
+    for(; iter.rem; xcb_input_xi_device_info_next(&iter)) {
+        xcb_input_xi_device_info_t* device = iter.data;
+        // the name isn't null terminated
+        int nameLen = MIN_NAME_LEN(xcb_input_xi_device_info_name_length(device));
+        memcpy(name, xcb_input_xi_device_info_name(device), nameLen);
+        name[nameLen] = 0;
+        switch(device->type) {
+            case XCB_INPUT_DEVICE_TYPE_MASTER_POINTER:
                 continue;
-            case XISlaveKeyboard:
-            case XISlavePointer :
-            case XIFloatingSlave:
-                if(!isTestDevice(device->name)) {
-                    Slave* slave = findElement(getAllSlaves(), &device->deviceid, sizeof(MasterID));
+            case XCB_INPUT_DEVICE_TYPE_SLAVE_KEYBOARD:
+            case XCB_INPUT_DEVICE_TYPE_SLAVE_POINTER:
+            case XCB_INPUT_DEVICE_TYPE_FLOATING_SLAVE:
+                if(!isTestDevice(name)) {
+                    Slave* slave = getSlaveByID(device->deviceid);
                     if(slave) {
                         setMasterForSlave(slave, device->attachment);
                     }
                     else
-                        newSlave(device->deviceid, device->attachment, device->use == XISlaveKeyboard, device->name);
+                        newSlave(device->deviceid, device->attachment,
+                            device->type == XCB_INPUT_DEVICE_TYPE_SLAVE_KEYBOARD, name);
                 }
                 break;
-            case XIMasterKeyboard: {
-                if(findElement(getAllMasters(), &device->deviceid, sizeof(MasterID)))
+            case XCB_INPUT_DEVICE_TYPE_MASTER_KEYBOARD: {
+                if(getMasterByID(device->deviceid))
                     continue;
                 int lastSpace = 0;
-                for(int n = 0; device->name[n]; n++)
-                    if(device->name[n] == ' ')
+                for(int n = 0; name[n]; n++)
+                    if(name[n] == ' ')
                         lastSpace = n;
                 if(lastSpace)
-                    device->name[lastSpace] = 0;
-                newMaster(device->deviceid, device->attachment, device->name);
+                    name[lastSpace] = 0;
+                newMaster(device->deviceid, device->attachment, name);
             }
         }
     }
-    XIFreeDeviceInfo(devices);
+    free(reply);
     assert(getAllMasters()->size >= 1);
     assert(getActiveMaster());
 }
 void initCurrentMasters() {
-    registerMasterDevice(XIAllDevices);
+    registerMasterDevice(XCB_INPUT_DEVICE_ALL);
 }
 
 Master* getMasterByDeviceID(MasterID id) {
     Master* master = getMasterByID(id);
     if(!master) {
-        Slave* slave = findElement(getAllSlaves(), &id, sizeof(MasterID));
+        Slave* slave = getSlaveByID(id);
         if(slave)
             master = getMasterForSlave(slave);
     }
@@ -154,23 +164,17 @@ bool getMousePosition(MasterID id, int relativeWindow, int16_t result[2]) {
     }
     return reply ? 1 : 0;
 }
-/*
-static int getAssociatedMasterDevice(int deviceID) {
-    int ndevices;
-    XIDeviceInfo* masterDevices;
-    MasterID id;
-    masterDevices = XIQueryDevice(dpy, deviceID, &ndevices);
-    id = masterDevices[0].attachment;
-    XIFreeDeviceInfo(masterDevices);
-    return id;
-}
-*/
 void setClientPointerForWindow(WindowID window, MasterID id) {
     XCALL(xcb_input_xi_set_client_pointer, dis, window, id);
 }
 MasterID getClientPointerForWindow(WindowID win) {
-    MasterID masterPointer;
-    XIGetClientPointer(dpy, win, (int*)&masterPointer);
+    MasterID masterPointer = 0;
+    xcb_input_xi_get_client_pointer_reply_t* reply = xcb_input_xi_get_client_pointer_reply(dis,
+            xcb_input_xi_get_client_pointer(dis, win), NULL);
+    if(reply) {
+        masterPointer = reply->deviceid;
+        free(reply);
+    }
     return masterPointer;
 }
 Master* getClientMaster(WindowID win) {
@@ -186,15 +190,67 @@ WindowID getActiveFocusOfMaster(MasterID id) {
     }
     return win;
 }
-void detectMonitors(void) {
+/// set when the monitors reported by the X server may no longer match our records
+static bool monitorsOutOfDate = 1;
+/// number of RandR requests sent
+static uint32_t randrRequestCount;
+uint32_t getRandrRequestCount(void) {
+    return randrRequestCount;
+}
+void markMonitorsAsOutOfDate(void) {
+    monitorsOutOfDate = 1;
+}
+#ifndef NO_XRANDR
+/// first event of the RandR extension or 0 if it isn't supported
+static uint8_t randrFirstEvent;
+void listenForMonitorChanges(void) {
+    randrFirstEvent = 0;
+    const xcb_query_extension_reply_t* reply = xcb_get_extension_data(dis, &xcb_randr_id);
+    if(!reply || !reply->present) {
+        WARN("RandR extension is not supported");
+        return;
+    }
+    randrFirstEvent = reply->first_event;
+    randrRequestCount++;
+    xcb_randr_select_input(dis, root, XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE | XCB_RANDR_NOTIFY_MASK_CRTC_CHANGE |
+        XCB_RANDR_NOTIFY_MASK_OUTPUT_CHANGE | XCB_RANDR_NOTIFY_MASK_RESOURCE_CHANGE);
+}
+void onRandrEvent(xcb_generic_event_t* event) {
+    uint8_t type = event->response_type & 127;
+    if(randrFirstEvent && (type == randrFirstEvent + XCB_RANDR_SCREEN_CHANGE_NOTIFY ||
+            type == randrFirstEvent + XCB_RANDR_NOTIFY)) {
+        TRACE("Received RandR event %d", type - randrFirstEvent);
+        markMonitorsAsOutOfDate();
+    }
+}
+#else
+void listenForMonitorChanges(void) {}
+void onRandrEvent(xcb_generic_event_t* event) {}
+#endif
+void refreshMonitorsIfOutOfDate(void) {
+    if(monitorsOutOfDate && detectMonitors())
+        applyEventRules(SCREEN_CHANGE, NULL);
+}
+bool detectMonitors(void) {
+    monitorsOutOfDate = 0;
 #ifdef NO_XRANDR
     addRootMonitor();
     removeDuplicateMonitors();
+    return 1;
 #else
     DEBUG("refreshing monitors");
+    bool changed = 0;
+    Monitor* primary = getPrimaryMonitor();
+    MonitorID oldPrimary = primary ? primary->id : 0;
+    randrRequestCount++;
     xcb_randr_get_monitors_cookie_t cookie = xcb_randr_get_monitors(dis, root, 1);
     xcb_randr_get_monitors_reply_t* monitors = xcb_randr_get_monitors_reply(dis, cookie, NULL);
     assert(monitors);
+    int numMonitors = xcb_randr_get_monitors_monitors_length(monitors);
+    // names are only fetched for new monitors; all requests are sent before waiting on any reply
+    xcb_get_atom_name_cookie_t nameCookies[numMonitors + 1];
+    Monitor* newMonitors[numMonitors + 1];
+    int numNewMonitors = 0;
     xcb_randr_monitor_info_iterator_t iter = xcb_randr_get_monitors_monitors_iterator(monitors);
     while(iter.rem) {
         xcb_randr_monitor_info_t* monitorInfo = iter.data;
@@ -202,25 +258,38 @@ void detectMonitors(void) {
         if(!m) {
             DEBUG("New monitor detected: %d", monitorInfo->name);
             m = newMonitor(monitorInfo->name, *(Rect*)&monitorInfo->x, monitorInfo->primary, "", 0);
+            nameCookies[numNewMonitors] = xcb_get_atom_name(dis, monitorInfo->name);
+            newMonitors[numNewMonitors++] = m;
+            changed = 1;
         }
-        else
+        else if(memcmp(&m->base, &monitorInfo->x, sizeof(Rect))) {
             setBase(m, *(Rect*)&monitorInfo->x);
-        getAtomName(monitorInfo->name, m->name);
+            changed = 1;
+        }
         if(monitorInfo->primary)
             setPrimary(m->id);
         m->_mark = 1;
         xcb_randr_monitor_info_next(&iter);
     }
     free(monitors);
-    if(getPrimaryMonitor())
-        DEBUG("Primary is %d", getPrimaryMonitor()->id);
+    for(int i = 0; i < numNewMonitors; i++)
+        getAtomNameReply(nameCookies[i], newMonitors[i]->name);
     FOR_EACH_R(Monitor*, m, getAllMonitors()) {
-        if(!m->fake && !m->_mark)
+        if(!m->fake && !m->_mark) {
             freeMonitor(m);
+            changed = 1;
+        }
         else
             m->_mark = 0;
     }
-#endif
+    primary = getPrimaryMonitor();
+    if(primary)
+        DEBUG("Primary is %d", primary->id);
+    if((primary ? primary->id : 0) != oldPrimary)
+        changed = 1;
+    uint32_t numberOfMonitors = getAllMonitors()->size;
     removeDuplicateMonitors();
     DEBUG("Number of monitors after consolidation %d", getAllMonitors()->size);
+    return changed || numberOfMonitors != getAllMonitors()->size;
+#endif
 }
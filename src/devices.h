@@ -14,6 +14,21 @@
 #include "xutil/xsession.h"
 
 
+/**
+ * Asks the X server to notify us of RandR changes so monitors are only re-queried when they may have changed
+ */
+void listenForMonitorChanges(void);
+/**
+ * Marks the monitors as out of date if event is a RandR screen change notification or RRNotify
+ *
+ * @param event
+ */
+void onRandrEvent(xcb_generic_event_t* event);
+/**
+ * @return the number of RandR requests sent so far
+ */
+uint32_t getRandrRequestCount(void);
+
 void registerMasterDevice(MasterID id);
 
 /**
@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "boundfunction.h"
+#include "event-recorder.h"
+#include "user-events.h"
+#include "util/debug.h"
+#include "util/logger.h"
+#include "util/time.h"
+#include "xevent.h"
+#include "xutil/xsession.h"
+
+static FILE* recording;
+static uint32_t recordingStartTime;
+
+bool isRecordingEvents(void) {
+    return recording;
+}
+bool startRecordingEvents(const char* path) {
+    stopRecordingEvents();
+    recording = fopen(path, "ab");
+    if(!recording) {
+        WARN("Could not open %s to record events", path);
+        return 0;
+    }
+    fseek(recording, 0, SEEK_END);
+    if(!ftell(recording)) {
+        RecordingHeader header = {EVENT_RECORDING_MAGIC, EVENT_RECORDING_VERSION};
+        fwrite(&header, sizeof(header), 1, recording);
+    }
+    recordingStartTime = getTime();
+    INFO("Recording events to %s", path);
+    return 1;
+}
+void stopRecordingEvents(void) {
+    if(recording)
+        fclose(recording);
+    recording = NULL;
+}
+
+/**
+ * @param event
+ *
+ * @return the number of bytes xcb allocated for event
+ */
+static uint32_t getEventSize(const xcb_generic_event_t* event) {
+    if((event->response_type & 127) == XCB_GE_GENERIC)
+        return sizeof(xcb_generic_event_t) + ((xcb_ge_generic_event_t*)event)->length * 4;
+    return sizeof(xcb_generic_event_t);
+}
+static void writeRecord(const void* event, uint32_t size) {
+    RecordedEvent record = {getTime() - recordingStartTime, size};
+    fwrite(&record, sizeof(record), 1, recording);
+    if(size)
+        fwrite(event, size, 1, recording);
+}
+void recordEvent(const xcb_generic_event_t* event) {
+    writeRecord(event, getEventSize(event));
+}
+void recordIdle(void) {
+    writeRecord(NULL, 0);
+}
+
+/**
+ * @param event
+ *
+ * @return the UserEvent the event will be dispatched as
+ */
+static UserEvent getRecordedEventType(const xcb_generic_event_t* event) {
+    int type = event->response_type & 127;
+    if(type == XCB_GE_GENERIC) {
+        int eventType = ((xcb_ge_generic_event_t*)event)->event_type;
+        return eventType <= XI_LASTEVENT ? GENERIC_EVENT_OFFSET + eventType : EXTRA_EVENT;
+    }
+    return type < LASTEvent ? type : EXTRA_EVENT;
+}
+
+/// Time spent processing a single type of event
+typedef struct {
+    uint32_t count;
+    uint64_t totalTime;
+    uint64_t maxTime;
+} EventTypeStats;
+
+static void reportReplay(FILE* output, const EventTypeStats* stats, int numEvents, uint64_t totalTime) {
+    fprintf(output, "Replayed %d events in %.3fs (%.0f events/s)\n", numEvents, totalTime / 1e6,
+        totalTime ? numEvents * 1e6 / totalTime : 0);
+    fprintf(output, "%-24s %8s %10s %10s\n", "type", "count", "avg (us)", "max (us)");
+    for(int i = 0; i < NUMBER_OF_MPX_EVENTS; i++)
+        if(stats[i].count)
+            fprintf(output, "%-24s %8u %10.1f %10lu\n", eventTypeToString(i), stats[i].count,
+                (double)stats[i].totalTime / stats[i].count, (unsigned long)stats[i].maxTime);
+}
+
+int replayEvents(const char* path, FILE* output) {
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        WARN("Could not open recording %s", path);
+        return -1;
+    }
+    RecordingHeader header;
+    if(fread(&header, sizeof(header), 1, file) != 1 || header.magic != EVENT_RECORDING_MAGIC ||
+        header.version != EVENT_RECORDING_VERSION) {
+        WARN("%s is not a valid recording", path);
+        fclose(file);
+        return -1;
+    }
+    EventTypeStats stats[NUMBER_OF_MPX_EVENTS] = {0};
+    int numEvents = 0;
+    uint64_t totalTime = 0;
+    RecordedEvent record;
+    while(fread(&record, sizeof(record), 1, file) == 1) {
+        xcb_generic_event_t* event = NULL;
+        if(record.size) {
+            if(record.size < sizeof(xcb_generic_event_t)) {
+                WARN("Recording %s is truncated", path);
+                break;
+            }
+            event = malloc(record.size);
+            if(fread(event, record.size, 1, file) != 1) {
+                WARN("Recording %s is truncated", path);
+                free(event);
+                break;
+            }
+        }
+        UserEvent type = event ? getRecordedEventType(event) : IDLE;
+        uint64_t start = getMicroTime();
+        if(event) {
+            processXEvent(event);
+            numEvents++;
+        }
+        else {
+            applyEventRules(IDLE, NULL);
+            flush();
+        }
+        uint64_t elapsed = getMicroTime() - start;
+        totalTime += elapsed;
+        stats[type].count++;
+        stats[type].totalTime += elapsed;
+        if(elapsed > stats[type].maxTime)
+            stats[type].maxTime = elapsed;
+    }
+    fclose(file);
+    if(output)
+        reportReplay(output, stats, numEvents, totalTime);
+    return numEvents;
+}
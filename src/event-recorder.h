@@ -0,0 +1,79 @@
+/**
+ * @file event-recorder.h
+ * @brief Record the X events the WM handles and replay them to reproduce and benchmark real workloads
+ *
+ * A recording is a RecordingHeader followed by one RecordedEvent per event, each followed by the raw xcb event.
+ * A record with a size of 0 marks a point where the event loop went idle and the IDLE rules were run.
+ *
+ * Replaying a recording against a different X server (ie Xvfb) will likely generate errors because the
+ * windows/devices referred to won't exist, but the events still go through the same dispatch path.
+ */
+#ifndef MPX_EVENT_RECORDER_H_
+#define MPX_EVENT_RECORDER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <xcb/xcb.h>
+
+/// Identifies a file as a recording of X events
+#define EVENT_RECORDING_MAGIC 0x5250584D
+/// Bumped when the format of a recording changes
+#define EVENT_RECORDING_VERSION 1
+
+/// Start of every recording
+typedef struct {
+    /// EVENT_RECORDING_MAGIC
+    uint32_t magic;
+    /// EVENT_RECORDING_VERSION
+    uint32_t version;
+} RecordingHeader;
+
+/// Prefix of every event in a recording
+typedef struct {
+    /// time (in ms) since the recording started
+    uint32_t timestamp;
+    /// the number of bytes of the event that follows or 0 for an idle marker
+    uint32_t size;
+} RecordedEvent;
+
+/**
+ * Starts writing every event processed to path.
+ * If path already exists, events are appended to it so a recording survives restarts
+ *
+ * @param path
+ *
+ * @return 1 iff path could be opened
+ */
+bool startRecordingEvents(const char* path);
+/**
+ * Stops recording events and closes the recording
+ */
+void stopRecordingEvents(void);
+/**
+ * @return 1 iff events are being recorded
+ */
+bool isRecordingEvents(void);
+/**
+ * Appends event to the recording
+ *
+ * @param event an event returned by xcb
+ */
+void recordEvent(const xcb_generic_event_t* event);
+/**
+ * Marks that the event loop went idle
+ */
+void recordIdle(void);
+
+/**
+ * Feeds every event of the recording at path through processXEvent as fast as possible and
+ * runs the IDLE rules at each idle marker.
+ * The events/second and the count, average and max time spent on each type of event are written to output.
+ *
+ * @param path
+ * @param output where to write the report or NULL
+ *
+ * @return the number of events replayed or -1 if path isn't a valid recording
+ */
+int replayEvents(const char* path, FILE* output);
+#endif
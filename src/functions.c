@@ -19,7 +19,7 @@
 
 static int getNextIndexInStack2(const ArrayList* stack, int delta, const WindowFunctionArg rule,
     bool includeNonActivatable) {
-    int index = getFocusedWindow() ? getIndex(stack, getFocusedWindow(), sizeof(WindowID)) : -1;
+    int index = getFocusedWindow() ? getIndexOfPointer(stack, getFocusedWindow()) : -1;
     if(index == -1)
         index = delta > 0 ? -1 : 0;
     for(int i = 0; i < stack->size; i++) {
@@ -40,9 +40,27 @@ static WindowInfo* getNextWindowInStack(const ArrayList* stack, int delta, const
     int index = getNextIndexInStack2(stack, delta, rule, includeNonActivatable);
     return index != -1 ? getElement(stack, index) : NULL;
 }
+/**
+ * Like getNextWindowInStack but walks the focus stack of the active master starting from the focused window
+ */
+static WindowInfo* getNextWindowInFocusStack(int delta, const WindowFunctionArg rule, bool includeNonActivatable) {
+    Master* master = getActiveMaster();
+    FocusNode* node = getFocusedWindow() ? getFocusNode(master, getFocusedWindow()) : NULL;
+    if(!node && delta < 0)
+        node = master->focusStackHead;
+    for(int i = 0; i < master->focusStackSize; i++) {
+        node = getNextFocusNode(master, node, delta);
+        WindowInfo* winInfo = node->winInfo;
+        if((includeNonActivatable || isActivatable(winInfo)) && (!rule.func || rule.func(winInfo, rule.arg))) {
+            return winInfo;
+        }
+    }
+    DEBUG("Could not find window");
+    return NULL;
+}
 
 void cycleWindowsMatching(int delta, bool(*filter)(WindowInfo*)) {
-    WindowInfo* winInfo = getNextWindowInStack(getActiveMasterWindowStack(), delta, (WindowFunctionArg) {filter}, 0);
+    WindowInfo* winInfo = getNextWindowInFocusStack(delta, (WindowFunctionArg) {filter}, 0);
     if(winInfo)
         activateWindow(winInfo);
 }
@@ -72,7 +90,7 @@ static void applyAction(WindowInfo* winInfo, WindowAction action) {
 WindowInfo* findAndRaise(const WindowFunctionArg rule, WindowAction action, const FindAndRaiseArg arg) {
     WindowInfo* target = NULL;
     if(!arg.skipMasterStack)
-        target = getNextWindowInStack(getMasterWindowStack(getActiveMaster()), 1, rule, arg.includeNonActivatable);
+        target = getNextWindowInFocusStack(1, rule, arg.includeNonActivatable);
     if(!target) {
         target = getNextWindowInStack(getAllWindows(), 1, rule, arg.includeNonActivatable);
         if(target)
@@ -88,14 +106,14 @@ WindowInfo* findAndRaise(const WindowFunctionArg rule, WindowAction action, cons
     return target;
 }
 bool matchesClass(WindowInfo* winInfo, const char* str) {
-    INFO("MatchesClass %d ''%s '%s' vs  %s", winInfo->id, winInfo->className, winInfo->instanceName, str);
-    return strcmp(winInfo->className, str) == 0 || strcmp(winInfo->instanceName, str) == 0;
+    INFO("MatchesClass %d ''%s '%s' vs  %s", winInfo->id, getClassName(winInfo), getInstanceName(winInfo), str);
+    return strcmp(getClassName(winInfo), str) == 0 || strcmp(getInstanceName(winInfo), str) == 0;
 }
 bool matchesTitle(WindowInfo* winInfo, const char* str) {
-    return strcmp(winInfo->title, str) == 0;
+    return strcmp(getTitle(winInfo), str) == 0;
 }
 bool matchesRole(WindowInfo* winInfo, const char* str) {
-    return strcmp(winInfo->role, str) == 0;
+    return strcmp(getRole(winInfo), str) == 0;
 }
 
 int raiseOrRunFunc(const char* s, const char* cmd, bool(*func)(WindowInfo*, const char*)) {
@@ -161,8 +179,9 @@ void centerMouseInWindow(WindowInfo* winInfo) {
 }
 Monitor* getSmallestMonitorContainingRect(const Rect rect) {
     Monitor* smallestMonitor = NULL;
-    FOR_EACH(Monitor*, m, getAllMonitors()) {
-        if(intersects(m->base, rect) && getWorkspaceOfMonitor(m))
+    const ArrayList* candidates = getMonitorsIntersecting(rect);
+    FOR_EACH(Monitor*, m, candidates) {
+        if(getWorkspaceOfMonitor(m))
             if(!smallestMonitor || getArea(smallestMonitor->base) > getArea(m->base))
                 smallestMonitor = m;
     }
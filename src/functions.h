@@ -14,6 +14,7 @@
 #include "masters.h"
 #include "monitors.h"
 #include "wmfunctions.h"
+#include "xutil/window-properties.h"
 
 /// Direction towards the head of the list
 #define UP -1
@@ -143,7 +144,7 @@ void sendWindowToWorkspaceByName(WindowInfo* winInfo, const char* name);
 void swapPosition(int dir);
 
 static inline bool matchesFocusedWindowClass(WindowInfo* winInfo) {
-    return matchesClass(winInfo, getFocusedWindow()->className);
+    return matchesClass(winInfo, getClassName(getFocusedWindow()));
 }
 /**
  * Shifts the focus up or down the window& stack
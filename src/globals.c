@@ -6,9 +6,12 @@
 
 bool ALLOW_SETTING_UNSYNCED_MASKS = 0;
 bool ALLOW_UNSAFE_OPTIONS = 1;
+bool ASYNC_LOGGING = 1;
+bool IPC_USE_SOCKET = 1;
 bool LD_PRELOAD_INJECTION = 0;
 bool RUN_AS_WM = 1;
 bool STEAL_WM_SELECTION = 0;
+bool USE_POSIX_SPAWN = 1;
 int16_t DEFAULT_BORDER_WIDTH = 1;
 const char* LD_PRELOAD_PATH = "/usr/lib/libmpx-patch.so";
 const char* MASTER_INFO_PATH = "$HOME/.config/mpxmanager/master-info.txt";
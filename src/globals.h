@@ -38,6 +38,8 @@
 
 #define __CAT(x, y) x ## y
 #define _CAT(x, y) __CAT(x, y)
+#define __STR(x) #x
+#define _STR(x) __STR(x)
 
 /**
  * Window Manager name used to comply with EWMH
@@ -51,8 +53,18 @@ extern bool ALLOW_SETTING_UNSYNCED_MASKS;
 /// If false, then unsafe options won't be proccessed
 extern bool ALLOW_UNSAFE_OPTIONS;
 
+/// If true, the WM writes log messages from a separate thread so the event loop never blocks on stdout
+extern bool ASYNC_LOGGING;
+
+/// If true, requests are sent/received over a UNIX socket instead of X properties when possible; can be overridden
+/// by the IPC_USE_SOCKET environment variable
+extern bool IPC_USE_SOCKET;
+
 /// if true, then preload LD_PRELOAD_PATH
 extern bool LD_PRELOAD_INJECTION;
+/// If true, children are spawned with posix_spawn and a prebuilt environment instead of forking the WM when possible.
+/// Children that outlive us are put in a new session instead of being double forked
+extern bool USE_POSIX_SPAWN;
 /**
  * If true, then we won't automatically ignore windows with the override redirect flag set.
  * Even so we cannot properly manage then; Effectively the flags STICKY and FLOATING would be set (we set them by default too)
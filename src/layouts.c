@@ -293,8 +293,18 @@ void retileAllDirtyWorkspaces() {
 }
 
 
+static bool tilingDeferred;
+void setTilingDeferred(bool defer) {
+    tilingDeferred = defer;
+}
+
 void tileWorkspace(Workspace* workspace) {
     assert(workspace);
+    if(tilingDeferred) {
+        TRACE("Deferring tiling of workspace %d", workspace->id);
+        workspace->dirty = 1;
+        return;
+    }
     DEBUG("Tiling workspace %d", workspace->id);
     ArrayList* windowStack = getWorkspaceWindowStack(workspace);
     if(!isWorkspaceVisible(workspace) || !windowStack->size) {
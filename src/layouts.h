@@ -208,6 +208,13 @@ void arrangeNonTileableWindow(const WindowInfo* winInfo, const Monitor* monitor)
  * @param workspace the workspace to tile
  */
 void tileWorkspace(Workspace* workspace);
+/**
+ * While set, tileWorkspace() will only mark the workspace as dirty instead of tiling it.
+ * This allows a series of changes to result in a single retile via retileAllDirtyWorkspaces()
+ *
+ * @param defer
+ */
+void setTilingDeferred(bool defer);
 
 /**
  * Windows will be the size of the monitor view port
@@ -7,6 +7,7 @@
 #include "masters.h"
 #include "mywm-structs.h"
 #include "util/time.h"
+#include "windows.h"
 
 ///the active master
 static Master* master = NULL;
@@ -15,6 +16,29 @@ static ArrayList masterList;
 const ArrayList* getAllMasters(void) {
     return &masterList;
 }
+/// incremented whenever a master is added or removed
+static uint32_t masterSetVersion;
+uint32_t getMasterSetVersion(void) {
+    return masterSetVersion;
+}
+/// maps the id of both the keyboard and pointer of a master to the Master
+static Master* mastersByID[MAX_DEVICE_ID];
+/**
+ * Points the entry of id in mastersByID at the first master matching id
+ *
+ * @param id
+ */
+static void updateMasterDeviceIndex(MasterID id) {
+    if(id >= MAX_DEVICE_ID)
+        return;
+    mastersByID[id] = NULL;
+    FOR_EACH(Master*, master, getAllMasters()) {
+        if(master->id == id || master->pointerID == id) {
+            mastersByID[id] = master;
+            break;
+        }
+    }
+}
 
 __DEFINE_GET_X_BY_NAME(Master)
 Master* getActiveMaster(void) {
@@ -31,6 +55,9 @@ Master* newMaster(MasterID pointerID, MasterID keyboardID, const char* name) {
     Master temp = {.id = pointerID, keyboardID = keyboardID, .focusColor = DEFAULT_BORDER_COLOR};
     memmove(master, &temp, sizeof(Master));
     addElement(&masterList, master);
+    masterSetVersion++;
+    updateMasterDeviceIndex(master->id);
+    updateMasterDeviceIndex(master->pointerID);
     strncpy(master->name, name, MAX_NAME_LEN - 1);
     return master;
 }
@@ -40,7 +67,10 @@ void freeMaster(Master* master) {
     clearArray(&master->bindings);
     if(getActiveMaster() == master)
         setActiveMaster(getHead(getAllMasters()));
-    removeElement(&masterList, master, sizeof(MasterID));
+    removeElementByPointer(&masterList, master);
+    masterSetVersion++;
+    updateMasterDeviceIndex(master->id);
+    updateMasterDeviceIndex(master->pointerID);
     if(master->windowMoveResizer)
         free(master->windowMoveResizer);
     free(master);
@@ -52,24 +82,81 @@ void addDefaultMaster() {
     if(getActiveMaster() == NULL)
         setActiveMaster(m);
 }
+static void unlinkFocusNode(Master* master, FocusNode* node) {
+    if(node->prev)
+        node->prev->next = node->next;
+    else
+        master->focusStackHead = node->next;
+    if(node->next)
+        node->next->prev = node->prev;
+    else
+        master->focusStackTail = node->prev;
+    node->prev = node->next = NULL;
+    master->windowStackDirty = 1;
+}
+/**
+ * Inserts node into the focus stack of master before the node before or at the end if before is NULL
+ */
+static void linkFocusNodeBefore(Master* master, FocusNode* node, FocusNode* before) {
+    node->next = before;
+    node->prev = before ? before->prev : master->focusStackTail;
+    if(node->prev)
+        node->prev->next = node;
+    else
+        master->focusStackHead = node;
+    if(before)
+        before->prev = node;
+    else
+        master->focusStackTail = node;
+    master->windowStackDirty = 1;
+}
+static void freeFocusNode(Master* master, FocusNode* node) {
+    if(master->focusedNode == node)
+        master->focusedNode = node->prev ? node->prev : node->next;
+    unlinkFocusNode(master, node);
+    master->focusStackSize--;
+    removeElementByPointer(&node->winInfo->focusNodes, node);
+    free(node);
+}
+FocusNode* getFocusNode(Master* master, WindowInfo* winInfo) {
+    return findElement(&winInfo->focusNodes, &master->id, sizeof(MasterID));
+}
+FocusNode* getNextFocusNode(Master* master, FocusNode* node, int delta) {
+    for(int i = 0; i < (delta < 0 ? -delta : delta); i++) {
+        if(delta > 0)
+            node = node && node->next ? node->next : master->focusStackHead;
+        else
+            node = node && node->prev ? node->prev : master->focusStackTail;
+    }
+    return node;
+}
+const ArrayList* getMasterWindowStack(Master* master) {
+    if(master->windowStackDirty) {
+        master->windowStack.size = 0;
+        for(FocusNode* node = master->focusStackHead; node; node = node->next)
+            addElement(&master->windowStack, node->winInfo);
+        master->windowStackDirty = 0;
+    }
+    return &master->windowStack;
+}
 void onWindowFocusForMaster(WindowID win, Master* master) {
     WindowInfo* winInfo = getWindowInfo(win);
     if(!winInfo)
         return;
-    int pos = getIndex(&master->windowStack, &win, sizeof(WindowID));
-    DEBUG("updating focus for win %d at position %d", win, pos);
-    if(! isFocusStackFrozen()) {
-        if(pos == -1) {
-            pos = master->windowStack.size;
-            addElement(&master->windowStack, winInfo);
-        }
-        shiftToHead(&master->windowStack, pos);
+    FocusNode* node = getFocusNode(master, winInfo);
+    DEBUG("updating focus for win %d; already in focus stack %d", win, node != NULL);
+    if(!node) {
+        node = malloc(sizeof(FocusNode));
+        *node = (FocusNode) {.masterID = master->id, .winInfo = winInfo};
+        addElement(&winInfo->focusNodes, node);
+        master->focusStackSize++;
+        linkFocusNodeBefore(master, node, isFocusStackFrozen() ? master->focusedNode : master->focusStackHead);
     }
-    else if(pos != -1)
-        master->focusedWindowIndex = pos;
-    else {
-        addElementAt(&master->windowStack, winInfo, master->focusedWindowIndex);
+    else if(!isFocusStackFrozen() && node != master->focusStackHead) {
+        unlinkFocusNode(master, node);
+        linkFocusNodeBefore(master, node, master->focusStackHead);
     }
+    master->focusedNode = node;
     master->focusedTimeStamp = getTime();
 }
 void onWindowFocus(WindowID win) {
@@ -77,21 +164,30 @@ void onWindowFocus(WindowID win) {
     onWindowFocusForMaster(win, master);
 }
 void clearFocusStack(Master* master) {
+    while(master->focusStackHead)
+        freeFocusNode(master, master->focusStackHead);
     clearArray(&master->windowStack);
+    master->windowStackDirty = 0;
 }
 WindowInfo* removeWindowFromFocusStack(Master* master, WindowID win) {
-    int index  = getIndex(&master->windowStack, &win, sizeof(WindowID));
-    if(index == -1)
+    WindowInfo* winInfo = getWindowInfo(win);
+    FocusNode* node = winInfo ? getFocusNode(master, winInfo) : NULL;
+    if(!node)
         return NULL;
-    if(master->focusedWindowIndex) {
-        master->focusedWindowIndex -= master->focusedWindowIndex >= index;
+    freeFocusNode(master, node);
+    return winInfo;
+}
+void removeWindowFromAllFocusStacks(WindowInfo* winInfo) {
+    while(winInfo->focusNodes.size) {
+        FocusNode* node = getHead(&winInfo->focusNodes);
+        Master* master = getMasterByID(node->masterID);
+        assert(master);
+        freeFocusNode(master, node);
     }
-    return removeIndex(&master->windowStack, index);
+    clearArray(&winInfo->focusNodes);
 }
 WindowInfo* getFocusedWindowOfMaster(Master* master) {
-    if(master->windowStack.size == 0)
-        return NULL;
-    return getElement(&master->windowStack, master->focusedWindowIndex);
+    return master->focusedNode ? master->focusedNode->winInfo : NULL;
 }
 WindowInfo* getFocusedWindow() {
     return getFocusedWindowOfMaster(getActiveMaster());
@@ -101,14 +197,19 @@ void setFocusStackFrozen(int value) {
     Master* master =  getActiveMaster();
     if(master->freezeFocusStack != value) {
         master->freezeFocusStack = value;
-        if(master->focusedWindowIndex < master->windowStack.size) {
-            shiftToHead(&master->windowStack, master->focusedWindowIndex);
-            master->focusedWindowIndex = 0;
+        if(master->focusedNode && master->focusedNode != master->focusStackHead) {
+            unlinkFocusNode(master, master->focusedNode);
+            linkFocusNodeBefore(master, master->focusedNode, master->focusStackHead);
         }
     }
 }
 
 Master* getMasterByID(MasterID id) {
+    if(id < MAX_DEVICE_ID) {
+        if(!mastersByID[id])
+            TRACE("Could not find master matching %d out of %d Masters", id, getAllMasters()->size);
+        return mastersByID[id];
+    }
     FOR_EACH(Master*, master, getAllMasters()) {
         if(master->id == id || master->pointerID == id) {
             return master;
@@ -126,7 +227,7 @@ void setMasterForSlave(Slave* slave, MasterID master) {
         if(slave->attachment) {
             Master* m = getMasterForSlave(slave);
             if(m)
-                removeElement(&m->slaves, &slave->id, sizeof(MasterID));
+                removeElementByPointer(&m->slaves, slave);
         }
         slave->attachment = master;
         if(slave->attachment) {
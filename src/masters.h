@@ -35,6 +35,10 @@ void freeMaster(Master* master);
  * @return a list of all master devices
  */
 const ArrayList* getAllMasters(void);
+/**
+ * @return a number that changes every time a master is created or destroyed
+ */
+uint32_t getMasterSetVersion(void);
 /**
  *
  * @return The master device currently interacting with the wm
@@ -49,6 +53,21 @@ Master* getActiveMaster(void);
 void setActiveMaster(Master* master);
 
 struct Binding;
+/**
+ * Node of the focus stack of a master.
+ * Each window has one node for every master that has focused it, so the window can be found, moved and removed
+ * from the stack in constant time
+ */
+typedef struct FocusNode {
+    /// id of the master whose focus stack this node is part of
+    MasterID masterID;
+    /// the window this node represents
+    WindowInfo* winInfo;
+    /// the more recently focused neighbour or NULL
+    struct FocusNode* prev;
+    /// the less recently focused neighbour or NULL
+    struct FocusNode* next;
+} FocusNode;
 /// holds data on a master device pair like the ids and focus history
 typedef struct Master {
     /// id of a master keyboard device
@@ -62,14 +81,22 @@ typedef struct Master {
     /**Stack of windows in order of most recently focused*/
     ArrayList slaves;
 
-    /**Stack of windows in order of most recently focused*/
-    ArrayList windowStack;
+    /// most recently focused window
+    FocusNode* focusStackHead;
+    /// least recently focused window
+    FocusNode* focusStackTail;
     /**
      * Contains the window with current focus,
      * will be same as top of window stack if freezeFocusStack==0
      *
      */
-    uint32_t focusedWindowIndex;
+    FocusNode* focusedNode;
+    /// number of nodes in the focus stack
+    uint32_t focusStackSize;
+    /**Stack of windows in order of most recently focused; lazily rebuilt from the focus stack*/
+    ArrayList windowStack;
+    /// set when windowStack no longer reflects the focus stack
+    bool windowStackDirty;
 
     /**Time the focused window changed*/
     TimeStamp focusedTimeStamp;
@@ -92,9 +119,11 @@ static inline const ArrayList* getSlaves(Master* master) {
     return &master->slaves;
 }
 
-static inline const ArrayList* getMasterWindowStack(Master* master) {
-    return &master->windowStack;
-}
+/**
+ * @param master
+ * @return list of windows in order of most recently focused
+ */
+const ArrayList* getMasterWindowStack(Master* master);
 static inline const ArrayList* getActiveMasterWindowStack() { return getMasterWindowStack(getActiveMaster());}
 
 /**
@@ -186,6 +215,29 @@ void clearFocusStack(Master* master);
  * @return the window removed or NULL
  */
 WindowInfo* removeWindowFromFocusStack(Master* master, WindowID win);
+/**
+ * Removes winInfo from the focus stack of every master
+ *
+ * @param winInfo
+ */
+void removeWindowFromAllFocusStacks(WindowInfo* winInfo);
+/**
+ * @param master
+ * @param winInfo
+ * @return the node representing winInfo in the focus stack of master or NULL
+ */
+FocusNode* getFocusNode(Master* master, WindowInfo* winInfo);
+/**
+ * Returns the node delta positions away from node in the focus stack of master, wrapping around at either end.
+ * If node is NULL, the walk starts just before the head of the stack
+ *
+ * @param master
+ * @param node
+ * @param delta
+ *
+ * @return the node or NULL if the stack is empty
+ */
+FocusNode* getNextFocusNode(Master* master, FocusNode* node, int delta);
 
 /**
  * Get the WindowInfo representing the window the master is
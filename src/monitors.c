@@ -24,15 +24,61 @@ Monitor* getMonitorByID(MonitorID id) {
     return findElement(getAllMonitors(), &id, sizeof(MonitorID));
 }
 
+/// all monitors sorted by base.x; rebuilt lazily after monitors are added, removed or moved
+static Monitor** sortedMonitors;
+/// the number of elements in sortedMonitors
+static uint32_t numSortedMonitors;
+/// the largest width of any monitor in sortedMonitors
+static uint16_t maxMonitorWidth;
+static bool monitorIndexDirty = 1;
+
+static void rebuildMonitorIndex(void) {
+    if(!monitorIndexDirty)
+        return;
+    sortedMonitors = realloc(sortedMonitors, sizeof(Monitor*) * (getAllMonitors()->size + 1));
+    numSortedMonitors = 0;
+    maxMonitorWidth = 0;
+    FOR_EACH(Monitor*, monitor, getAllMonitors()) {
+        uint32_t i = numSortedMonitors++;
+        // insertion sort so monitors with the same x remain in list order
+        for(; i > 0 && sortedMonitors[i - 1]->base.x > monitor->base.x; i--)
+            sortedMonitors[i] = sortedMonitors[i - 1];
+        sortedMonitors[i] = monitor;
+        if(monitor->base.width > maxMonitorWidth)
+            maxMonitorWidth = monitor->base.width;
+    }
+    monitorIndexDirty = 0;
+}
+const ArrayList* getMonitorsIntersecting(const Rect rect) {
+    static ArrayList result;
+    clearArray(&result);
+    rebuildMonitorIndex();
+    // monitors starting at or before minX are too far left to reach rect
+    int minX = rect.x - maxMonitorWidth;
+    uint32_t lower = 0, upper = numSortedMonitors;
+    while(lower < upper) {
+        uint32_t mid = (lower + upper) / 2;
+        if(sortedMonitors[mid]->base.x <= minX)
+            lower = mid + 1;
+        else
+            upper = mid;
+    }
+    for(uint32_t i = lower; i < numSortedMonitors && sortedMonitors[i]->base.x < rect.x + rect.width; i++)
+        if(intersects(sortedMonitors[i]->base, rect))
+            addElement(&result, sortedMonitors[i]);
+    return &result;
+}
+
 uint32_t MONITOR_DUPLICATION_POLICY = SAME_DIMS;
 uint32_t MONITOR_DUPLICATION_RESOLUTION = TAKE_PRIMARY | TAKE_LARGER;
 
 Monitor* newMonitor(MonitorID id, Rect base, bool primary, const char* name, bool fake) {
     Monitor* monitor = (Monitor*)malloc(sizeof(Monitor));
-    Monitor temp = {.id = id, .base = base, .view = base, .primary = primary, .fake = fake};
+    Monitor temp = {.id = id, .base = base, .view = base, .primary = primary, .fake = fake, .viewDirty = 1};
     memmove(monitor, &temp, sizeof(Monitor));
     strncpy(monitor->name, name, MAX_NAME_LEN - 1);
     addElement(getAllMonitors(), monitor);
+    monitorIndexDirty = 1;
     return monitor;
 }
 Monitor* addFakeMonitorWithName(Rect bounds, const char* name) {
@@ -46,7 +92,8 @@ Monitor* addFakeMonitorWithName(Rect bounds, const char* name) {
 void freeMonitor(Monitor* monitor) {
     if(getWorkspaceOfMonitor(monitor))
         setMonitor(getWorkspaceOfMonitor(monitor), NULL);
-    removeElement(&monitors, monitor, sizeof(MonitorID));
+    removeElementByPointer(&monitors, monitor);
+    monitorIndexDirty = 1;
     free(monitor);
 }
 
@@ -59,6 +106,27 @@ bool isMonitorActive(Monitor* monitor) {
     return !monitor->inactive && monitor->view.width && monitor->view.height;
 }
 
+/**
+ * @param winInfo a dock
+ * @return the area of the root window winInfo reserves
+ */
+static Rect getDockArea(WindowInfo* winInfo) {
+    DockType i = winInfo->dockProperties.type;
+    int thickness = winInfo->dockProperties.thickness;
+    int start = winInfo->dockProperties.start;
+    int end = winInfo->dockProperties.end;
+    bool fromPositiveSide = (i == DOCK_LEFT) || (i == DOCK_TOP);
+    bool offset = (i == DOCK_TOP) || (i == DOCK_BOTTOM);
+    if(end == 0)
+        end = offset ? getRootWidth() : getRootHeight();
+    assert(start <= end);
+    short int values[] = {0, 0, 0, 0};
+    values[offset] = fromPositiveSide ? 0 : (offset ? getRootHeight() : getRootWidth()) - thickness;
+    values[!offset] = start;
+    values[offset + 2] = thickness;
+    values[!offset + 2] = end - start;
+    return *((Rect*)values);
+}
 /**
  *
  * Adjusts the viewport so that it doesn't intersect winInfo
@@ -80,23 +148,14 @@ bool resizeToAvoidDock(Monitor* monitor, WindowInfo* winInfo) {
         TRACE("Dock %d has is disabled Thickness %d; Mapped %d", winInfo->id, thickness, hasMask(winInfo, MAPPED_MASK));
         return 0;
     }
-    int start = winInfo->dockProperties.start;
-    int end = winInfo->dockProperties.end;
     bool fromPositiveSide = (i == DOCK_LEFT) || (i == DOCK_TOP);
     bool offset = (i == DOCK_TOP) || (i == DOCK_BOTTOM);
-    if(end == 0)
-        end = offset ? getRootWidth() : getRootHeight();
-    assert(start <= end);
-    short int values[] = {0, 0, 0, 0};
-    values[offset] = fromPositiveSide ? 0 : (offset ? getRootHeight() : getRootWidth()) - thickness;
-    values[!offset] = start;
-    values[offset + 2] = thickness;
-    values[!offset + 2] = end - start;
-    if(!intersects(monitor->view, *((Rect*)values)))
+    const Rect area = getDockArea(winInfo);
+    if(!intersects(monitor->view, area))
         return 0;
     int intersectionWidth = fromPositiveSide ?
         thickness - (&monitor->view.x)[offset] :
-        (&monitor->view.x)[offset] + (&monitor->view.width)[offset] - values[offset];
+        (&monitor->view.x)[offset] + (&monitor->view.width)[offset] - (&area.x)[offset];
     assert(intersectionWidth > 0);
     INFO("%d %d", intersectionWidth, (&monitor->view.width)[offset]);
     (&monitor->view.width)[offset] = (&monitor->view.width)[offset] > intersectionWidth ?
@@ -108,14 +167,80 @@ bool resizeToAvoidDock(Monitor* monitor, WindowInfo* winInfo) {
     return 1;
 }
 
-void resizeAllMonitorsToAvoidAllDocks(void) {
+/// The space a dock reserved the last time monitor views were computed
+typedef struct {
+    /// the id of the dock
+    WindowID id;
+    /// the reserved area or an empty rect if the dock didn't reserve any space
+    Rect area;
+    /// the workspace of the dock
+    Workspace* workspace;
+    /// if the dock only applied to the primary monitor
+    bool primaryOnly;
+} ReservedArea;
+///list of the ReservedArea of every dock
+static ArrayList reservedAreas;
+
+static ReservedArea getReservedArea(WindowInfo* winInfo) {
+    ReservedArea reservedArea = {.id = winInfo->id};
+    if(winInfo->dockProperties.thickness && hasMask(winInfo, MAPPED_MASK)) {
+        reservedArea.area = getDockArea(winInfo);
+        reservedArea.workspace = getWorkspaceOfWindow(winInfo);
+        reservedArea.primaryOnly = hasMask(winInfo, PRIMARY_MONITOR_MASK);
+    }
+    return reservedArea;
+}
+static bool isSameReservedArea(const ReservedArea* a, const ReservedArea* b) {
+    return memcmp(&a->area, &b->area, sizeof(Rect)) == 0 && a->workspace == b->workspace &&
+        a->primaryOnly == b->primaryOnly;
+}
+static void markMonitorsIntersectingDirty(Rect area) {
+    if(!area.width || !area.height)
+        return;
     FOR_EACH(Monitor*, monitor, getAllMonitors()) {
+        if(intersects(monitor->base, area))
+            monitor->viewDirty = 1;
+    }
+}
+uint32_t resizeMonitorsWithChangedStruts(void) {
+    FOR_EACH_R(ReservedArea*, reservedArea, &reservedAreas) {
+        if(!findElement(getAllDocks(), reservedArea, sizeof(WindowID))) {
+            markMonitorsIntersectingDirty(reservedArea->area);
+            free(removeElementByPointer(&reservedAreas, reservedArea));
+        }
+    }
+    FOR_EACH(WindowInfo*, winInfo, getAllDocks()) {
+        ReservedArea* reservedArea = findElement(&reservedAreas, winInfo, sizeof(WindowID));
+        if(!reservedArea) {
+            reservedArea = calloc(1, sizeof(ReservedArea));
+            reservedArea->id = winInfo->id;
+            addElement(&reservedAreas, reservedArea);
+        }
+        ReservedArea current = getReservedArea(winInfo);
+        if(!isSameReservedArea(reservedArea, &current)) {
+            TRACE("Reserved area of dock %d changed", winInfo->id);
+            markMonitorsIntersectingDirty(reservedArea->area);
+            markMonitorsIntersectingDirty(current.area);
+            *reservedArea = current;
+        }
+    }
+    uint32_t count = 0;
+    FOR_EACH(Monitor*, monitor, getAllMonitors()) {
+        if(!monitor->viewDirty)
+            continue;
+        monitor->viewDirty = 0;
         monitor->view = monitor->base;
-        FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {
-            if(winInfo->dock && hasMask(winInfo, MAPPED_MASK))
+        FOR_EACH(WindowInfo*, winInfo, getAllDocks()) {
+            if(hasMask(winInfo, MAPPED_MASK))
                 resizeToAvoidDock(monitor, winInfo);
         }
+        count++;
     }
+    TRACE("Recomputed view of %d monitors", count);
+    return count;
+}
+void resizeAllMonitorsToAvoidAllDocks(void) {
+    resizeMonitorsWithChangedStruts();
 }
 
 void resizeAllMonitorsToAvoidDock(WindowInfo* winInfo) {
@@ -132,10 +257,20 @@ void removeDuplicateMonitors(void) {
         TRACE("MONITOR_DUPLICATION_POLICY or MONITOR_DUPLICATION_RESOLUTION is not set");
         return;
     }
-    for(int32_t i = getAllMonitors()->size - 1; i >= 0; i--) {
-        Monitor* m1 = getElement(getAllMonitors(), i);
-        for(int32_t n = getAllMonitors()->size - 1; n > i; n--) {
-            Monitor* m2 = getElement(getAllMonitors(), n);
+    rebuildMonitorIndex();
+    uint32_t size = numSortedMonitors;
+    Monitor* sorted[size + 1];
+    memcpy(sorted, sortedMonitors, sizeof(Monitor*) * size);
+    // Sweep from left to right; duplicates always overlap or touch along the x axis so only monitors that start before
+    // the current one ends need to be considered
+    for(uint32_t i = 0; i < size; i++) {
+        for(uint32_t n = i + 1; sorted[i] && n < size; n++) {
+            if(!sorted[n])
+                continue;
+            if(sorted[n]->base.x > sorted[i]->base.x + sorted[i]->base.width)
+                break;
+            Monitor* m1 = sorted[i];
+            Monitor* m2 = sorted[n];
             if((m1->fake || m2->fake) && (MONITOR_DUPLICATION_POLICY & CONSIDER_ONLY_NONFAKES))
                 continue;
             bool dup =
@@ -146,6 +281,11 @@ void removeDuplicateMonitors(void) {
                     containsProper(m2->base, m1->base));
             if(!dup)
                 continue;
+            // order by position in the list of monitors so ties are always broken the same way
+            if(getIndexOfPointer(getAllMonitors(), m1) > getIndexOfPointer(getAllMonitors(), m2)) {
+                m1 = sorted[n];
+                m2 = sorted[i];
+            }
             Monitor* monitorToRemove = NULL;
             DEBUG("Monitors %u and %u are duplicates", m1->id, m2->id);
             if(MONITOR_DUPLICATION_RESOLUTION & TAKE_SMALLER)
@@ -157,9 +297,11 @@ void removeDuplicateMonitors(void) {
             if(monitorToRemove) {
                 DEBUG("removing monitor %u because it is a duplicate of %u", monitorToRemove->id,
                     monitorToRemove->id ^ m1->id ^ m2->id);
+                if(monitorToRemove == sorted[i])
+                    sorted[i] = NULL;
+                else
+                    sorted[n] = NULL;
                 freeMonitor(monitorToRemove);
-                if(monitorToRemove == m1)
-                    break;
             }
         }
     }
@@ -206,21 +348,31 @@ Monitor* getPrimaryMonitor() {
 }
 
 void setPrimary(MonitorID id) {
+    if(primaryMonitor == id)
+        return;
+    // docks that only apply to the primary monitor now affect a different monitor
+    Monitor* oldPrimary = getPrimaryMonitor();
+    if(oldPrimary)
+        oldPrimary->viewDirty = 1;
     primaryMonitor = id;
+    Monitor* newPrimary = getPrimaryMonitor();
+    if(newPrimary)
+        newPrimary->viewDirty = 1;
 }
 bool isPrimary(Monitor* monitor) {
     return primaryMonitor == monitor->id;
 }
 
 void setBase(Monitor* monitor, const Rect rect) {
+    // the view is still valid if the base hasn't changed
+    if(memcmp(&monitor->base, &rect, sizeof(Rect)) == 0)
+        return;
     monitor->base = monitor->view = rect;
+    monitor->viewDirty = 1;
+    monitorIndexDirty = 1;
 }
 Workspace* getWorkspaceOfMonitor(Monitor* monitor) {
-    FOR_EACH(Workspace*, workspace, getAllWorkspaces()) {
-        if(getMonitor(workspace) == monitor)
-            return workspace;
-    }
-    return NULL;
+    return monitor->workspace;
 }
 
 static const uint16_t* rootDim;
@@ -34,6 +34,10 @@ struct Monitor {
     bool inactive;
     /// Raise windows relative to this window (default 0)
     WindowID stackingWindow;
+    /// set when view needs to be recomputed to avoid docks
+    bool viewDirty;
+    /// the workspace displayed on this monitor; kept in sync by setMonitor
+    Workspace* workspace;
 };
 
 Monitor* newMonitor(MonitorID id, Rect base, bool primary, const char* name, bool fake);
@@ -130,9 +134,20 @@ static inline Workspace* getPrimaryWorkspace() {
 void removeDuplicateMonitors(void);
 
 /**
- * Query for all monitors
+ * Query for all monitors.
+ * The names of new monitors are requested together; existing monitors keep their name
+ *
+ * @return 1 iff a monitor was added, removed, moved or the primary monitor changed
+ */
+bool detectMonitors(void);
+/**
+ * Marks that the monitors need to be re-queried the next time refreshMonitorsIfOutOfDate is called
  */
-void detectMonitors(void);
+void markMonitorsAsOutOfDate(void);
+/**
+ * Calls detectMonitors if the monitors are out of date and triggers SCREEN_CHANGE iff something actually changed
+ */
+void refreshMonitorsIfOutOfDate(void);
 /**
  * Loops over all monitors and assigns the ones without a workspace to an arbitrary empty workspace
  */
@@ -140,7 +155,15 @@ void assignUnusedMonitorsToWorkspaces(void);
 
 
 /**
- * @see resizeMonitorToAvoidStruct
+ * Recomputes the view of every monitor that may be affected by a dock whose reserved area has changed
+ * (or was added/removed) since the last call and of every monitor whose base has changed.
+ * Other monitors are left untouched.
+ *
+ * @return the number of monitors whose view was recomputed
+ */
+uint32_t resizeMonitorsWithChangedStruts(void);
+/**
+ * @see resizeMonitorsWithChangedStruts
  */
 void resizeAllMonitorsToAvoidAllDocks(void);
 /**
@@ -188,4 +211,13 @@ Monitor* addFakeMonitorWithName(Rect bounds, const char* name);
 static inline Monitor* addFakeMonitor(Rect bounds) {return addFakeMonitorWithName(bounds, "");}
 
 void setBase(Monitor* monitor, const Rect rect);
+/**
+ * Finds all monitors whose base intersects rect using an index sorted by x, so only monitors that could overlap are
+ * checked.
+ *
+ * @param rect
+ *
+ * @return a list of the matching monitors which is only valid until the next call
+ */
+const ArrayList* getMonitorsIntersecting(const Rect rect);
 #endif
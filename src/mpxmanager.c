@@ -2,13 +2,17 @@
 #include <err.h>
 #include <getopt.h>
 #include <signal.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
 #include "communications.h"
+#include "event-recorder.h"
 #include "globals.h"
 #include "settings.h"
 #include "system.h"
+#include "util/ipc-socket.h"
+#include "util/latency-probe.h"
 #include "util/logger.h"
 #include "wm-rules.h"
 #include "wmfunctions.h"
@@ -42,17 +46,34 @@ static void dumpOptions() {
 static void setWindow(WindowID win) { active = win;}
 static void noEventLoop() {RUN_EVENT_LOOP = 0;}
 static void replaceWM() {STEAL_WM_SELECTION = 1;}
+static void noIPCSocket() {IPC_USE_SOCKET = 0;}
+static void syncLogging() {ASYNC_LOGGING = 0;}
+static void latencyProbe() {enableLatencyProbe(1);}
+static void recordEvents(const char* path) {
+    if(!startRecordingEvents(path))
+        exit(SYS_CALL_FAILED);
+}
+/// if set, the events recorded in this file will be replayed instead of running the event loop
+static const char* replayPath;
+static void setReplayPath(const char* path) {replayPath = path;}
 static void dumpStartupOptions();
+static void sendBatch();
 /// list of startup options
 static Option options[] = {
+    {"latency-probe", {latencyProbe}},
     {"list-start-options", {dumpStartupOptions}},
     {"log-level", {setLogLevel}, .flags = VAR_SETTER | REQUEST_INT},
     {"list-options", {dumpOptions}},
     {"no-event-loop", {noEventLoop}},
+    {"no-ipc-socket", {noIPCSocket}},
     {"no-run-as-window-manager", {clearWMSettings}},
+    {"record-events", {recordEvents}, .flags = REQUEST_STR},
     {"replace", {replaceWM}},
+    {"replay-events", {setReplayPath}, .flags = REQUEST_STR},
+    {"sync-logging", {syncLogging}},
     {"die-on-idle", {addShutdownOnIdleRule}},
     {"as", {setWindow}, .flags = REQUEST_INT},
+    {"batch", {sendBatch}},
 };
 static void dumpStartupOptions() {
     for(int i = 0; i < LEN(options); i++)
@@ -74,7 +95,7 @@ static inline bool callStartupOption(const char* const* argv, int* n) {
         Option* option = &options[i];
         bool increment = 0;
         if(strcmp(argv[*n] + 2, option->name) == 0) {
-            if(option->flags & REQUEST_INT) {
+            if(option->flags & (REQUEST_INT | REQUEST_STR)) {
                 value = argv[*n + 1];
                 increment = 1;
             }
@@ -91,6 +112,70 @@ static inline bool callStartupOption(const char* const* argv, int* n) {
     }
     return 0;
 }
+/**
+ * Opens a connection to the X server, if needed, in order to send requests to the running WM
+ */
+static void connectToWM(void) {
+    if(!hasXConnectionBeenOpened()) {
+        openXDisplay();
+        clearWMSettings();
+    }
+    if(!isMPXManagerRunning())
+        exit(WM_NOT_RESPONDING);
+    noEventLoop();
+}
+
+/**
+ * Reads commands, one per line, from stdin and sends them to the WM as a single request.
+ * Each line is of the form "name [value [value2]]" where value2 is the remainder of the line.
+ * The commands are run together without the WM processing other events in between and
+ * workspaces are retiled at most once afterwards.
+ *
+ * If the WM isn't listening on the ipc socket, the commands are sent individually
+ */
+static void sendBatch() {
+    static IPCCommand commands[IPC_MAX_BATCH_SIZE];
+    char line[3 * MAX_NAME_LEN];
+    int numCommands = 0;
+    while(fgets(line, sizeof(line), stdin)) {
+        line[strcspn(line, "\n")] = 0;
+        char* name = strtok(line, " \t");
+        if(!name || name[0] == '#')
+            continue;
+        char* value = strtok(NULL, " \t");
+        char* value2 = value ? strtok(NULL, "") : NULL;
+        if(value2)
+            value2 += strspn(value2, " \t");
+        if(!findOption(name, value, value2)) {
+            ERROR("Could not find matching options for %s.", name);
+            exit(INVALID_OPTION);
+        }
+        if(numCommands == LEN(commands)) {
+            ERROR("At most %d commands can be batched", (int)LEN(commands));
+            exit(INVALID_OPTION);
+        }
+        commands[numCommands++] = (IPCCommand) {strdup(name), value ? strdup(value) : NULL, value2 ? strdup(value2) : NULL};
+    }
+    if(!numCommands)
+        exit(NORMAL_TERMINATION);
+    int statuses[numCommands];
+    int result = IPC_USE_SOCKET ? sendBatchOverIPCSocket(active, commands, numCommands, statuses) : -1;
+    if(result == -1) {
+        connectToWM();
+        for(int i = 0; i < numCommands; i++)
+            sendAs(commands[i].name, active, commands[i].value, commands[i].value2);
+        return;
+    }
+    int exitCode = result;
+    for(int i = 0; i < numCommands && !result; i++)
+        if(statuses[i]) {
+            ERROR("'%s' failed with status %d", commands[i].name, statuses[i]);
+            if(!exitCode)
+                exitCode = statuses[i];
+        }
+    exit(exitCode);
+}
+
 /**
  * Parse command line arguments starting the 1st index
  * @param argc the number of args to parse
@@ -113,14 +198,12 @@ static void parseArgs(int argc, const char* const* argv) {
             ERROR("Could not find matching options for %s.", argv[i]);
             exit(INVALID_OPTION);
         }
-        if(!hasXConnectionBeenOpened()) {
-            openXDisplay();
-            clearWMSettings();
-            RUN_EVENT_LOOP = 0;
+        if(IPC_USE_SOCKET) {
+            int status = sendOverIPCSocket(argv[i], active, argv[i + 1], argv[i + 1] ? argv[i + 2] : NULL);
+            if(status != -1)
+                exit(status);
         }
-        if(!isMPXManagerRunning())
-            exit(WM_NOT_RESPONDING);
-        noEventLoop();
+        connectToWM();
         sendAs(argv[i], active, argv[i + 1], argv[i + 1] ? argv[i + 2] : NULL);
         break;
     }
@@ -143,14 +226,22 @@ int _main(int argc, const char* const* argv) {
     numPassedArguments = argc;
     passedArguments = argv;
     initOptions();
+    const char* useIPCSocket = getenv("IPC_USE_SOCKET");
+    if(useIPCSocket)
+        IPC_USE_SOCKET = atoi(useIPCSocket);
     if(!startupMethod)
         startupMethod = loadSettings;
     if(argc > 1)
         parseArgs(argc, argv);
     if(!hasXConnectionBeenOpened())
         onStartup();
-    if(RUN_EVENT_LOOP)
+    if(replayPath)
+        return replayEvents(replayPath, stdout) == -1 ? INVALID_OPTION : 0;
+    if(RUN_EVENT_LOOP) {
+        if(RUN_AS_WM && ASYNC_LOGGING)
+            startAsyncLogging();
         runEventLoop();
+    }
     else if(getNumberOfMessageSent()) {
         if(hasOutStandingMessages()) {
             TRACE("waiting for send receipts");
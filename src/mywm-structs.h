@@ -21,6 +21,8 @@ typedef unsigned int WindowID;
 typedef unsigned int MasterID;
 /// typeof Slave::id
 typedef MasterID SlaveID;
+/// XI device ids are small integers bounded by the X server's max number of devices
+#define MAX_DEVICE_ID 256
 /// typeof Workspace::id
 typedef unsigned int WorkspaceID;
 /// typeof Monitor::id
@@ -6,6 +6,8 @@ static ArrayList slaveList;
 const ArrayList* getAllSlaves(void) {
     return &slaveList;
 }
+/// maps a device id to its Slave
+static Slave* slavesByID[MAX_DEVICE_ID];
 __DEFINE_GET_X_BY_NAME(Slave)
 
 void setMasterForSlave(Slave* slave, MasterID master);
@@ -15,15 +17,21 @@ Slave* newSlave(const MasterID id, MasterID attachment, bool keyboard, const cha
     memmove(slave, &temp, sizeof(Slave));
     strncpy(slave->name, name, MAX_NAME_LEN - 1);
     addElement(&slaveList, slave);
+    if(id < MAX_DEVICE_ID && !slavesByID[id])
+        slavesByID[id] = slave;
     setMasterForSlave(slave, attachment);
     return slave;
 }
 void freeSlave(Slave* slave) {
     setMasterForSlave(slave, 0);
-    removeElement(&slaveList, slave, sizeof(SlaveID));
+    removeElementByPointer(&slaveList, slave);
+    if(slave->id < MAX_DEVICE_ID && slavesByID[slave->id] == slave)
+        slavesByID[slave->id] = findElement(&slaveList, &slave->id, sizeof(SlaveID));
     free(slave);
 }
 Slave* getSlaveByID(SlaveID id) {
+    if(id < MAX_DEVICE_ID)
+        return slavesByID[id];
     FOR_EACH(Slave*, slave, getAllSlaves()) {
         if(slave->id == id) {
             return slave;
@@ -1,8 +1,11 @@
+#define _GNU_SOURCE
 #include <assert.h>
 #include <err.h>
 #include <fcntl.h>
 #include <pthread.h>
 #include <signal.h>
+#include <spawn.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/wait.h>
@@ -17,6 +20,7 @@
 #include "system.h"
 #include "windows.h"
 #include "workspaces.h"
+#include "xutil/window-properties.h"
 
 int statusPipeFD[4] = {0};
 int numPassedArguments;
@@ -34,55 +38,261 @@ void safePipe(int* fds) {
     INFO("Created pipes %d\n", fds[1]);
 }
 
-static inline void setEnvRect(const char* name, const Rect rect) {
+/// Sets the environment variable name to value in env
+typedef void (*EnvSetter)(void* env, const char* name, const char* value);
+/// Reads the environment variable name from env
+typedef const char* (*EnvGetter)(void* env, const char* name);
+
+static inline void setEnvRect(EnvSetter setter, void* env, const char* name, const Rect rect) {
     const char var[4][32] = {"_%s_X", "_%s_Y", "_%s_WIDTH", "_%s_HEIGHT"};
     char strName[32];
     char strValue[16];
     for(int n = 0; n < 4; n++) {
         sprintf(strName, var[n], name);
         sprintf(strValue, "%ud", ((short*)&rect)[n]);
-        setenv(strName, strValue, 1);
+        setter(env, strName, strValue);
+    }
+}
+/**
+ * Sets the variables that only depend on the active master
+ */
+static void setMasterEnvVars(EnvSetter setter, EnvGetter getter, void* env) {
+    char strValue[32];
+    sprintf(strValue, "%ud", getActiveMasterKeyboardID());
+    setter(env, DEFAULT_KEYBOARD_ENV_VAR_NAME, strValue);
+    sprintf(strValue, "%ud", getActiveMasterPointerID());
+    setter(env, DEFAULT_POINTER_ENV_VAR_NAME, strValue);
+    if(LD_PRELOAD_INJECTION) {
+        const char* previousPreload = getter(env, "LD_PRELOAD");
+        const char* preload_str = LD_PRELOAD_PATH;
+        char* buffer = NULL;
+        if(previousPreload && previousPreload[0]) {
+            buffer = calloc(1, strlen(previousPreload) + strlen(LD_PRELOAD_PATH) + 2);
+            strcat(buffer, LD_PRELOAD_PATH);
+            strcat(buffer, ":");
+            strcat(buffer, previousPreload);
+            preload_str = buffer;
+        }
+        setter(env, "LD_PRELOAD", preload_str);
+        if(buffer)
+            free(buffer);
+    }
+}
+/**
+ * Sets the variables that describe what the active master is focused on
+ */
+static void setFocusEnvVars(EnvSetter setter, void* env) {
+    char strValue[32];
+    if(getFocusedWindow()) {
+        sprintf(strValue, "%ud", getFocusedWindow()->id);
+        setter(env, "_WIN_ID", strValue);
+        // these were loaded before forking; see _spawn
+        setter(env, "_WIN_TITLE", getFocusedWindow()->title);
+        setter(env, "_WIN_CLASS", getFocusedWindow()->className);
+        setter(env, "_WIN_INSTANCE", getFocusedWindow()->instanceName);
+        setEnvRect(setter, env, "WIN", getFocusedWindow()->geometry);
     }
+    Monitor* m = getActiveWorkspace() ? getMonitor(getActiveWorkspace()) : NULL;
+    if(m) {
+        setEnvRect(setter, env, "MON", m->base);
+        setEnvRect(setter, env, "VIEW", m->view);
+        setter(env, "MONITOR_NAME", m->name);
+    }
+    const Rect rootBounds = {0, 0, getRootWidth(), getRootHeight()};
+    setEnvRect(setter, env, "ROOT", rootBounds);
+}
+static void setProcessEnv(void* unused, const char* name, const char* value) {
+    setenv(name, value, 1);
+}
+static const char* getProcessEnv(void* unused, const char* name) {
+    return getenv(name);
 }
 void setClientMasterEnvVar(void) {
-    static char strValue[32];
     if(getActiveMaster()) {
-        sprintf(strValue, "%ud", getActiveMasterKeyboardID());
-        setenv(DEFAULT_KEYBOARD_ENV_VAR_NAME, strValue, 1);
-        sprintf(strValue, "%ud", getActiveMasterPointerID());
-        setenv(DEFAULT_POINTER_ENV_VAR_NAME, strValue, 1);
-        if(getFocusedWindow()) {
-            sprintf(strValue, "%ud", getFocusedWindow()->id);
-            setenv("_WIN_ID", strValue, 1);
-            setenv("_WIN_TITLE", getFocusedWindow()->title, 1);
-            setenv("_WIN_CLASS", getFocusedWindow()->className, 1);
-            setenv("_WIN_INSTANCE", getFocusedWindow()->instanceName, 1);
-            setEnvRect("WIN", getFocusedWindow()->geometry);
-        }
-        Monitor* m = getActiveWorkspace() ? getMonitor(getActiveWorkspace()) : NULL;
-        if(m) {
-            setEnvRect("MON", m->base);
-            setEnvRect("VIEW", m->view);
-            setenv("MONITOR_NAME", m->name, 1);
-        }
-        const Rect rootBounds = {0, 0, getRootWidth(), getRootHeight()};
-        setEnvRect("ROOT", rootBounds);
-        if(LD_PRELOAD_INJECTION) {
-            const char* previousPreload = getenv("LD_PRELOAD");
-            const char* preload_str = LD_PRELOAD_PATH;
-            char* buffer = NULL;
-            if(previousPreload && previousPreload[0]) {
-                buffer = calloc(1, strlen(previousPreload) + strlen(LD_PRELOAD_PATH) + 1);
-                strcat(buffer, LD_PRELOAD_PATH);
-                strcat(buffer, ":");
-                strcat(buffer, previousPreload);
-                preload_str = buffer;
-            }
-            setenv("LD_PRELOAD", preload_str, 1);
-            if(buffer)
-                free(buffer);
+        setMasterEnvVars(setProcessEnv, getProcessEnv, NULL);
+        setFocusEnvVars(setProcessEnv, NULL);
+    }
+}
+
+extern char** environ;
+/// The environment of children spawned while a given master is active, minus what setFocusEnvVars sets
+typedef struct {
+    MasterID id;
+    /// list of owned "NAME=VALUE" strings
+    ArrayList vars;
+} SpawnEnvironment;
+/// list of SpawnEnvironment
+static ArrayList spawnEnvironments;
+/// the value of getMasterSetVersion when spawnEnvironments was last valid
+static uint32_t spawnEnvironmentsVersion;
+/// NULL terminated copy of the pointers of environ when spawnEnvironments was last valid
+static char** environSnapshot;
+
+/**
+ * @return the index of the entry for name in vars or -1
+ */
+static int findEnvVar(const ArrayList* vars, const char* name) {
+    int len = strlen(name);
+    for(int i = 0; i < vars->size; i++) {
+        const char* var = getElement(vars, i);
+        if(strncmp(var, name, len) == 0 && var[len] == '=')
+            return i;
+    }
+    return -1;
+}
+static const char* getEnvListVar(void* vars, const char* name) {
+    int index = findEnvVar(vars, name);
+    return index == -1 ? NULL : strchr(getElement(vars, index), '=') + 1;
+}
+static char* createEnvVar(const char* name, const char* value) {
+    char* var = malloc(strlen(name) + strlen(value) + 2);
+    sprintf(var, "%s=%s", name, value);
+    return var;
+}
+static void setEnvListVar(void* vars, const char* name, const char* value) {
+    int index = findEnvVar(vars, name);
+    if(index != -1)
+        free(removeIndex(vars, index));
+    addElement(vars, createEnvVar(name, value));
+}
+/**
+ * @return true if var will be set by setFocusEnvVars and so shouldn't be cached
+ */
+static bool isFocusEnvVar(const char* var) {
+    static const char* const prefixes[] = {"_WIN_", "_MON_", "_VIEW_", "_ROOT_", "MONITOR_NAME="};
+    for(int i = 0; i < LEN(prefixes); i++)
+        if(strncmp(var, prefixes[i], strlen(prefixes[i])) == 0)
+            return 1;
+    return 0;
+}
+/**
+ * setenv, putenv and unsetenv all replace entries of environ, so comparing pointers is enough to detect changes
+ *
+ * @return 1 iff environ has changed since the last call to snapshotEnviron
+ */
+static bool hasEnvironChanged(void) {
+    if(!environSnapshot)
+        return 1;
+    int i;
+    for(i = 0; environ[i] && environSnapshot[i]; i++)
+        if(environ[i] != environSnapshot[i])
+            return 1;
+    return environ[i] != environSnapshot[i];
+}
+static void snapshotEnviron(void) {
+    int size = 0;
+    while(environ[size])
+        size++;
+    free(environSnapshot);
+    environSnapshot = malloc(sizeof(char*) * (size + 1));
+    memcpy(environSnapshot, environ, sizeof(char*) * (size + 1));
+}
+void clearSpawnEnvironmentCache(void) {
+    FOR_EACH(SpawnEnvironment*, spawnEnv, &spawnEnvironments) {
+        FOR_EACH(char*, var, &spawnEnv->vars) {
+            free(var);
         }
+        clearArray(&spawnEnv->vars);
+        free(spawnEnv);
     }
+    clearArray(&spawnEnvironments);
+}
+/**
+ * @return the cached environment of the active master; built from environ if needed
+ */
+static const ArrayList* getSpawnEnvironment(void) {
+    if(spawnEnvironmentsVersion != getMasterSetVersion() || hasEnvironChanged()) {
+        clearSpawnEnvironmentCache();
+        spawnEnvironmentsVersion = getMasterSetVersion();
+        snapshotEnviron();
+    }
+    FOR_EACH(SpawnEnvironment*, spawnEnv, &spawnEnvironments) {
+        if(spawnEnv->id == getActiveMaster()->id)
+            return &spawnEnv->vars;
+    }
+    SpawnEnvironment* spawnEnv = calloc(1, sizeof(SpawnEnvironment));
+    spawnEnv->id = getActiveMaster()->id;
+    for(char** var = environ; *var; var++)
+        if(!isFocusEnvVar(*var))
+            addElement(&spawnEnv->vars, strcpy(malloc(strlen(*var) + 1), *var));
+    setMasterEnvVars(setEnvListVar, getEnvListVar, &spawnEnv->vars);
+    addElement(&spawnEnvironments, spawnEnv);
+    return &spawnEnv->vars;
+}
+
+/// pids of children spawned by spawnWithoutFork that are meant to outlive us and so nobody will wait on
+static ArrayList detachedChildren;
+
+void reapDetachedChildren(void) {
+    for(int i = detachedChildren.size - 1; i >= 0; i--)
+        if(waitpid((pid_t)(intptr_t)getElement(&detachedChildren, i), NULL, WNOHANG))
+            removeIndex(&detachedChildren, i);
+}
+uint32_t getNumberOfDetachedChildren(void) {
+    return detachedChildren.size;
+}
+
+/**
+ * Spawns command without forking the WM.
+ * The environment is the cached environment of the active master plus the variables describing what it is focused on.
+ * The child starts with default signal dispositions and an empty signal mask like an exec'd shell would.
+ * Children that aren't supposed to preserve our session are put in a new session instead of being double forked and
+ * are reaped by reapDetachedChildren.
+ *
+ * @return the pid of the child or -1 if posix_spawn failed
+ */
+static int spawnWithoutFork(const char* command, ChildRedirection spawnPipe, bool preserveSession, bool silent) {
+    char* const* envp = environ;
+    const ArrayList* vars = NULL;
+    ArrayList focusVars = {0};
+    if(onChildSpawn && getActiveMaster()) {
+        vars = getSpawnEnvironment();
+        setFocusEnvVars(setEnvListVar, &focusVars);
+    }
+    char* buffer[(vars ? vars->size : 0) + focusVars.size + 1];
+    if(vars) {
+        for(int i = 0; i < vars->size; i++)
+            buffer[i] = getElement(vars, i);
+        for(int i = 0; i < focusVars.size; i++)
+            buffer[vars->size + i] = getElement(&focusVars, i);
+        buffer[vars->size + focusVars.size] = NULL;
+        envp = buffer;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if(spawnPipe == REDIRECT_CHILD_INPUT_ONLY || spawnPipe == REDIRECT_BOTH)
+        posix_spawn_file_actions_adddup2(&actions, STATUS_FD_EXTERNAL_READ, STDIN_FILENO);
+    if(spawnPipe == REDIRECT_CHILD_OUTPUT_ONLY || spawnPipe == REDIRECT_BOTH)
+        posix_spawn_file_actions_adddup2(&actions, STATUS_FD_EXTERNAL_WRITE, STDOUT_FILENO);
+    if(silent) {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY | O_APPEND, 0);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY | O_APPEND, 0);
+    }
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t signals;
+    sigfillset(&signals);
+    posix_spawnattr_setsigdefault(&attr, &signals);
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attr, &signals);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK |
+        (preserveSession ? 0 : POSIX_SPAWN_SETSID));
+    const char* const args[] = {SHELL, "-c", command, NULL};
+    int pid;
+    int result = posix_spawn(&pid, args[0], &actions, &attr, (char* const*)args, envp);
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    FOR_EACH(char*, var, &focusVars) {
+        free(var);
+    }
+    clearArray(&focusVars);
+    if(result) {
+        DEBUG("posix_spawn failed with %d", result);
+        return -1;
+    }
+    if(!preserveSession)
+        addElement(&detachedChildren, (void*)(intptr_t)pid);
+    return pid;
 }
 
 void suppressOutput(void) {
@@ -104,7 +314,19 @@ static int _spawn(const char* command, ChildRedirection spawnPipe, bool preserve
             safePipe(statusPipeFD + 2);
         }
     }
-    int pid = fork();
+    // the child can't safely talk to the X server so load anything onChildSpawn may need now
+    if(onChildSpawn && getActiveMaster() && getFocusedWindow())
+        loadWindowStringProperties(getFocusedWindow(), WINDOW_CLASS_PROPERTY | WINDOW_TITLE_PROPERTY);
+    int pid = -1;
+    bool spawnedWithoutFork = 0;
+    reapDetachedChildren();
+    // onChildSpawn may be arbitrary code that has to run in a forked child
+    if(USE_POSIX_SPAWN && command && (onChildSpawn == setClientMasterEnvVar || !onChildSpawn)) {
+        pid = spawnWithoutFork(command, spawnPipe, preserveSession, silent);
+        spawnedWithoutFork = pid != -1;
+    }
+    if(pid == -1)
+        pid = fork();
     if(pid == 0) {
         if(!preserveSession)
             if(fork())
@@ -141,7 +363,8 @@ static int _spawn(const char* command, ChildRedirection spawnPipe, bool preserve
             close(STATUS_FD_EXTERNAL_READ);
         }
     }
-    if(!preserveSession)
+    // detached children spawned without forking are reaped later by reapDetachedChildren
+    if(!preserveSession && !spawnedWithoutFork)
         waitForChild(pid);
     return pid;
 }
@@ -168,18 +391,28 @@ int waitForChild(int pid) {
     return exitCode;
 }
 
-void restart() {
-    DEBUG("calling execv");
+static void __attribute__((__noreturn__)) execSelf() {
+    fflush(NULL);
     if(passedArguments)
         execv(passedArguments[0], (char**)passedArguments);
     err(SYS_CALL_FAILED, "exec failed; Aborting");
 }
+void restart() {
+    DEBUG("calling execv");
+    stopAsyncLogging();
+    execSelf();
+}
+static void restartOnSignal(int sig) {
+    writeQueuedLogMessagesFromSignal();
+    execSelf();
+}
 void quit(int exitCode) {
     DEBUG("Exiting");
     exit(exitCode);
 }
 
 static void handler(int sig) {
+    writeQueuedLogMessagesFromSignal();
     ERROR("Error: signal %d:", sig);
     LOG_RUN(LOG_LEVEL_WARN, printStackTrace());
     printSummary();
@@ -215,7 +448,7 @@ void set_handlers() {
     createSigAction(SIGABRT, handler);
     createSigAction(SIGTERM, handler);
     createSigAction(SIGPIPE, resetPipe);
-    createSigAction(SIGHUP, restart);
-    createSigAction(SIGUSR1, restart);
+    createSigAction(SIGHUP, restartOnSignal);
+    createSigAction(SIGUSR1, restartOnSignal);
     createSigAction(SIGUSR2, printStackTrace);
 }
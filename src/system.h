@@ -17,6 +17,7 @@
 #ifndef MPX_SYSTEM
 #define MPX_SYSTEM
 #include <stdbool.h>
+#include <stdint.h>
 
 /// @{
 /// Exit codes
@@ -88,12 +89,16 @@ int waitForChild(int pid);
 /**
  * Forks and, if command is not NULL, exec command in SHELL
  * The command run shall terminate independently of the parent.
+ * If USE_POSIX_SPAWN is set and onChildSpawn is the default, the WM isn't forked; the child is started in a new session
+ * and reaped by reapDetachedChildren instead of being double forked
  * @param command
  * @return the pid of the new process
  */
 void spawn(const char* command);
 /**
  * @copydoc spawn(const char*)
+ * Unlike spawn, the child isn't double forked and has to be waited on.
+ * If USE_POSIX_SPAWN is set and onChildSpawn is the default, the WM isn't forked; see clearSpawnEnvironmentCache
  *
  * @param preserveSession if true, spawn won't double fork
  * @param silent if 1, suppress output
@@ -126,6 +131,22 @@ extern void (*onChildSpawn)(void);
  * Set environment vars such to help old clients know which master device to use
  */
 void setClientMasterEnvVar(void);
+/**
+ * Drops the environments cached for children spawned without forking.
+ * They are rebuilt from environ on the next spawn.
+ * The cache is automatically cleared when a master is added or removed or when environ is modified with
+ * setenv/putenv/unsetenv; modifying the string passed to putenv in place isn't detected.
+ */
+void clearSpawnEnvironmentCache(void);
+/**
+ * Reaps, without blocking, any terminated children started by spawn/spawnPipe with posix_spawn.
+ * Called on every spawn and when idle.
+ */
+void reapDetachedChildren(void);
+/**
+ * @return the number of children started by spawn/spawnPipe with posix_spawn that haven't been reaped yet
+ */
+uint32_t getNumberOfDetachedChildren(void);
 
 void set_handlers();
 
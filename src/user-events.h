@@ -48,6 +48,8 @@ typedef enum {
      * Called anytime a managed window is configured. The filtering out of ignored windows is one of the main differences between this and XCB_CONFIGURE_NOTIFY. The other being that the WindowInfo object will be passed in when the rule is applied.
      */
     WINDOW_MOVE,
+    /// Called at most once per refresh when the title of a window has changed. The WindowInfo is passed in
+    WINDOW_TITLE_CHANGE,
     /// called when the connection is idle
     IDLE,
     /// called when the connection is idle (even after the calls to IDLE. )
@@ -2,15 +2,14 @@
 #include <assert.h>
 #include <stdlib.h>
 #include "arraylist.h"
-void* getElement(const ArrayList* array, int index) {
-    return array->__arr[index];
-}
 
+/// initial capacity of a list; lists are never shrunk below this
+#define ARRAY_LIST_MIN_SIZE 16
 void addElement(ArrayList* array, void* p) {
     if(array->size == array->maxSize) {
         if(array->maxSize)
             array->maxSize *= 2;
-        else array->maxSize = 16;
+        else array->maxSize = ARRAY_LIST_MIN_SIZE;
         array->__arr = realloc(array->__arr, sizeof(void*)*array->maxSize);
     }
     array->__arr[array->size++] = p;
@@ -32,18 +31,24 @@ void* removeElement(ArrayList* array, const void* p, size_t size) {
     int index = getIndex(array, p, size);
     return index != -1 ? removeIndex(array, index) : NULL;
 }
+void* removeElementByPointer(ArrayList* array, const void* p) {
+    int index = getIndexOfPointer(array, p);
+    return index != -1 ? removeIndex(array, index) : NULL;
+}
 void* removeIndex(ArrayList* array, uint32_t index) {
     void* value = getElement(array, index);
-    for(uint32_t i = index; i < array->size - 1; i++)
-        array->__arr[i] = array->__arr[i + 1];
+    memmove(&array->__arr[index], &array->__arr[index + 1], sizeof(void*) * (array->size - index - 1));
     array->size--;
+    if(array->maxSize > ARRAY_LIST_MIN_SIZE && array->size < array->maxSize / 4) {
+        array->maxSize /= 2;
+        array->__arr = realloc(array->__arr, sizeof(void*)*array->maxSize);
+    }
     return value;
 }
 void shiftToPos(ArrayList* array, uint32_t index, int endingPos) {
     assert(index >= endingPos);
     void* value = getElement(array, index);
-    for(int i = index; i > endingPos; i--)
-        array->__arr[i] = array->__arr[i - 1];
+    memmove(&array->__arr[endingPos + 1], &array->__arr[endingPos], sizeof(void*) * (index - endingPos));
     array->__arr[endingPos] = value;
 }
 void addElementAt(ArrayList* array, void* value, uint32_t index) {
@@ -13,7 +13,8 @@
 #define __VAR_CAT(x, y) __VAR_CAT_HELPER(x, y)
 
 #define FOR_EACH(TYPE, VAR, ARR) int __VAR_CAT(__i, __LINE__) = 0;\
-    for(TYPE VAR = (ARR)->size?getElement(ARR, __VAR_CAT(__i, __LINE__)):NULL; __VAR_CAT(__i, __LINE__) < (ARR)->size; VAR=getElement(ARR, ++__VAR_CAT(__i, __LINE__)))
+    for(TYPE VAR = (ARR)->size?getElement(ARR, __VAR_CAT(__i, __LINE__)):NULL; __VAR_CAT(__i, __LINE__) < (ARR)->size;\
+        VAR = ++__VAR_CAT(__i, __LINE__) < (ARR)->size ? getElement(ARR, __VAR_CAT(__i, __LINE__)) : NULL)
 #define FOR_EACH_R(TYPE, VAR, ARR) int __VAR_CAT(__i, __LINE__) = (ARR)->size;\
     for(TYPE VAR = (ARR)->size?getElement(ARR, __VAR_CAT(__i, __LINE__)-1):NULL; --__VAR_CAT(__i, __LINE__) >=0 && (VAR=getElement(ARR, __VAR_CAT(__i, __LINE__)));)
 typedef struct ArrayList {
@@ -22,14 +23,33 @@ typedef struct ArrayList {
     int maxSize;
 } ArrayList;
 
-void* getElement(const ArrayList* array, int index);
+static inline void* getElement(const ArrayList* array, int index) { return array->__arr[index];}
 static inline void* getHead(const ArrayList* array) { return getElement(array, 0);}
 void addElement(ArrayList* array, void* p);
 int getIndex(const ArrayList* array, const void* p, size_t size);
+/**
+ * Like getIndex but compares the elements themselves instead of the memory they point to
+ *
+ * @param p the element to look for
+ * @return the index of p or -1
+ */
+static inline int getIndexOfPointer(const ArrayList* array, const void* p) {
+    for(int i = 0; i < array->size; i++)
+        if(array->__arr[i] == p)
+            return i;
+    return -1;
+}
 void* findElement(const ArrayList* array, const void* p, size_t size);
 void* removeElement(ArrayList* array, const void* p, size_t size);
 /**
- * Remove the index-th element form list
+ * Removes p from the list; elements are compared by identity
+ * @param p
+ * @return p or NULL if p wasn't in the list
+ */
+void* removeElementByPointer(ArrayList* array, const void* p);
+/**
+ * Remove the index-th element form list.
+ * The backing storage is shrunk once the list is using less than a quarter of it
  * @param index
  * @return the element that was removed
  */
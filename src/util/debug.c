@@ -9,6 +9,7 @@
 #include "../window-masks.h"
 #include "../windows.h"
 #include "../workspaces.h"
+#include "../xutil/window-properties.h"
 #include "debug.h"
 #include "logger.h"
 
@@ -54,6 +55,7 @@ const char* eventTypeToString(int type) {
             _ADD_EVENT_TYPE_CASE(MONITOR_WORKSPACE_CHANGE);
             _ADD_EVENT_TYPE_CASE(SCREEN_CHANGE);
             _ADD_EVENT_TYPE_CASE(WINDOW_MOVE);
+            _ADD_EVENT_TYPE_CASE(WINDOW_TITLE_CHANGE);
             _ADD_EVENT_TYPE_CASE(TILE_WORKSPACE);
             _ADD_EVENT_TYPE_CASE(IDLE);
             _ADD_EVENT_TYPE_CASE(TRUE_IDLE);
@@ -151,9 +153,9 @@ void dumpMaster(Master* master) {
 void dumpWindowInfo(WindowInfo* winInfo) {
     printf("{ID %d%s ", winInfo->id, (isTileable(winInfo) ? "*" : !isMappable(winInfo) ? "?" :  ""));
     if(winInfo->type)
-        printf("Title '%s' Class '%s' '%s' ", winInfo->title, winInfo->className, winInfo->instanceName);
-    if(winInfo->role[0])
-        printf("Role '%s' ", winInfo->role);
+        printf("Title '%s' Class '%s' '%s' ", getTitle(winInfo), getClassName(winInfo), getInstanceName(winInfo));
+    if(getRole(winInfo)[0])
+        printf("Role '%s' ", getRole(winInfo));
     if(winInfo->dock) {
         printf("Dock ");
     }
@@ -173,7 +175,7 @@ void dumpWindowFilter(WindowMask filterMask) {
 }
 void dumpWindowByClass(const char* match) {
     FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {
-        if(!strcmp(winInfo->className, match) || !strcmp(winInfo->instanceName, match))
+        if(!strcmp(getClassName(winInfo), match) || !strcmp(getInstanceName(winInfo), match))
             dumpWindowInfo(winInfo);
     }
 }
@@ -0,0 +1,327 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../globals.h"
+#include "../system.h"
+#include "ipc-socket.h"
+#include "logger.h"
+
+static void setCloseOnExec(int fd) {
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+static void setReadTimeout(int fd, uint32_t ms) {
+    struct timeval timeout = {.tv_sec = ms / 1000, .tv_usec = (ms % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+static void initIPCSocketAddress(struct sockaddr_un* addr) {
+    *addr = (struct sockaddr_un) {.sun_family = AF_UNIX};
+    strncpy(addr->sun_path, getIPCSocketPath(), sizeof(addr->sun_path) - 1);
+}
+/**
+ * @param fd a connected socket
+ *
+ * @return 1 iff the process on the other end of fd is run by the same user as us
+ */
+static bool isPeerTrusted(int fd) {
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if(getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == -1 || cred.uid != getuid()) {
+        WARN("Rejecting ipc connection from another user");
+        return 0;
+    }
+    return 1;
+}
+
+const char* getIPCSocketDir(void) {
+    static char dir[sizeof(((struct sockaddr_un*)NULL)->sun_path) / 2];
+    const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+    if(runtimeDir && runtimeDir[0])
+        snprintf(dir, sizeof(dir), "%s", runtimeDir);
+    else
+        snprintf(dir, sizeof(dir), "/tmp/mpxmanager-%d", getuid());
+    return dir;
+}
+const char* getIPCSocketPath(void) {
+    static char path[sizeof(((struct sockaddr_un*)NULL)->sun_path)];
+    const char* display = getenv("DISPLAY");
+    snprintf(path, sizeof(path), "%s/mpxmanager%s", getIPCSocketDir(), display ? display : "");
+    return path;
+}
+/**
+ * Creates the directory of the socket if needed and verifies that only we can access it
+ *
+ * @return 1 iff the directory is private to the current user
+ */
+static bool initIPCSocketDir(void) {
+    const char* dir = getIPCSocketDir();
+    struct stat info;
+    if(mkdir(dir, S_IRWXU) == -1 && errno != EEXIST) {
+        WARN("could not create %s", dir);
+        return 0;
+    }
+    if(lstat(dir, &info) == -1 || !S_ISDIR(info.st_mode) || info.st_uid != getuid() ||
+        info.st_mode & (S_IRWXG | S_IRWXO)) {
+        WARN("%s is not a private directory owned by us; not listening on ipc socket", dir);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Binds fd to addr such that the created socket file is only accessible by the current user
+ */
+static bool bindPrivately(int fd, const struct sockaddr_un* addr) {
+    mode_t mask = umask(S_IRWXG | S_IRWXO);
+    bool bound = bind(fd, (const struct sockaddr*)addr, sizeof(*addr)) == 0;
+    umask(mask);
+    return bound;
+}
+
+int createIPCSocket(void) {
+    struct sockaddr_un addr;
+    initIPCSocketAddress(&addr);
+    if(!initIPCSocketDir())
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd == -1) {
+        WARN("could not create ipc socket");
+        return -1;
+    }
+    setCloseOnExec(fd);
+    bool bound = bindPrivately(fd, &addr);
+    if(!bound && errno == EADDRINUSE) {
+        int other = connectToIPCSocket();
+        if(other != -1) {
+            WARN("%s is already being listened on", addr.sun_path);
+            close(other);
+            close(fd);
+            return -1;
+        }
+        DEBUG("Removing stale socket %s", addr.sun_path);
+        unlink(addr.sun_path);
+        bound = bindPrivately(fd, &addr);
+    }
+    if(!bound || listen(fd, SOMAXCONN) == -1) {
+        WARN("could not listen on ipc socket %s", addr.sun_path);
+        close(fd);
+        return -1;
+    }
+    INFO("Listening for requests on %s", addr.sun_path);
+    return fd;
+}
+
+int connectToIPCSocket(void) {
+    struct sockaddr_un addr;
+    initIPCSocketAddress(&addr);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd == -1)
+        return -1;
+    if(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+        TRACE("could not connect to %s", addr.sun_path);
+        close(fd);
+        return -1;
+    }
+    // don't hand our stdout over to a socket some other user is listening on
+    if(!isPeerTrusted(fd)) {
+        close(fd);
+        return -1;
+    }
+    setCloseOnExec(fd);
+    return fd;
+}
+
+int sendIPCSocketBatchRequest(int fd, WindowID active, const IPCCommand* commands, uint32_t numCommands) {
+    if(!numCommands || numCommands > IPC_MAX_BATCH_SIZE) {
+        WARN("Cannot send a batch of %d commands", numCommands);
+        return -1;
+    }
+    char* payload = malloc(numCommands * 3 * MAX_NAME_LEN);
+    IPCRequestHeader header = {.active = active, .numCommands = numCommands};
+    for(int n = 0; n < numCommands; n++) {
+        const char* strings[] = {commands[n].name, commands[n].value, commands[n].value2};
+        for(int i = 0; i < LEN(strings); i++) {
+            const char* str = strings[i] ? strings[i] : "";
+            int len = strlen(str) + 1;
+            if(len > MAX_NAME_LEN) {
+                WARN("'%s' is too long to send", str);
+                free(payload);
+                return -1;
+            }
+            memcpy(payload + header.len, str, len);
+            header.len += len;
+        }
+    }
+    struct iovec iov[] = {{&header, sizeof(header)}, {payload, header.len}};
+    char control[CMSG_SPACE(sizeof(int))] = {0};
+    struct msghdr msg = {.msg_iov = iov, .msg_iovlen = LEN(iov), .msg_control = control, .msg_controllen = sizeof(control)};
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    int outputFD = STDOUT_FILENO;
+    memcpy(CMSG_DATA(cmsg), &outputFD, sizeof(int));
+    ssize_t result = sendmsg(fd, &msg, 0);
+    free(payload);
+    if(result != sizeof(header) + header.len) {
+        WARN("could not write request to ipc socket");
+        return -1;
+    }
+    return 0;
+}
+
+int sendIPCSocketRequest(int fd, const char* name, WindowID active, const char* value, const char* value2) {
+    IPCCommand command = {name, value, value2};
+    return sendIPCSocketBatchRequest(fd, active, &command, 1);
+}
+
+int receiveIPCSocketBatchResponse(int fd, int* statuses, uint32_t numCommands) {
+    int32_t buffer[numCommands];
+    setReadTimeout(fd, IDLE_TIMEOUT_CLI_SEC * 1000);
+    if(recv(fd, buffer, sizeof(buffer), MSG_WAITALL) != sizeof(buffer)) {
+        WARN("WM did not respond over ipc socket");
+        return -1;
+    }
+    for(int i = 0; i < numCommands; i++)
+        statuses[i] = buffer[i];
+    return 0;
+}
+
+int receiveIPCSocketResponse(int fd) {
+    int status;
+    return receiveIPCSocketBatchResponse(fd, &status, 1) ? WM_NOT_RESPONDING : status;
+}
+
+int sendBatchOverIPCSocket(WindowID active, const IPCCommand* commands, uint32_t numCommands, int* statuses) {
+    int fd = connectToIPCSocket();
+    if(fd == -1)
+        return -1;
+    int result = sendIPCSocketBatchRequest(fd, active, commands, numCommands) ||
+        receiveIPCSocketBatchResponse(fd, statuses, numCommands) ? WM_NOT_RESPONDING : 0;
+    close(fd);
+    return result;
+}
+
+int sendOverIPCSocket(const char* name, WindowID active, const char* value, const char* value2) {
+    IPCCommand command = {name, value, value2};
+    int status;
+    int result = sendBatchOverIPCSocket(active, &command, 1, &status);
+    return result ? result : status;
+}
+
+/**
+ * Reads the header and the caller's stdout, which is passed along with it
+ *
+ * @return the number of bytes read, 0 on EOF or -1 on error
+ */
+static ssize_t readIPCSocketRequestHeader(IPCConnection* connection) {
+    char control[CMSG_SPACE(sizeof(int))] = {0};
+    struct iovec iov = {(char*)&connection->header + connection->bytesRead, sizeof(IPCRequestHeader) - connection->bytesRead};
+    struct msghdr msg = {.msg_iov = &iov, .msg_iovlen = 1, .msg_control = control, .msg_controllen = sizeof(control)};
+    ssize_t result = recvmsg(connection->fd, &msg, 0);
+    struct cmsghdr* cmsg = result > 0 ? CMSG_FIRSTHDR(&msg) : NULL;
+    if(cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+        if(connection->request.outputFD != -1)
+            close(connection->request.outputFD);
+        memcpy(&connection->request.outputFD, CMSG_DATA(cmsg), sizeof(int));
+        setCloseOnExec(connection->request.outputFD);
+    }
+    return result;
+}
+/**
+ * Splits the payload into the name, value and value2 of each command
+ */
+static void parseIPCSocketRequest(IPCConnection* connection) {
+    const IPCRequestHeader* header = &connection->header;
+    IPCRequest* request = &connection->request;
+    request->payload[header->len] = 0;
+    request->active = header->active;
+    request->numCommands = header->numCommands;
+    request->commands = malloc(sizeof(IPCCommand) * header->numCommands);
+    for(int n = 0, offset = 0; n < header->numCommands; n++) {
+        const char** strings[] = {&request->commands[n].name, &request->commands[n].value, &request->commands[n].value2};
+        for(int i = 0; i < LEN(strings); i++) {
+            *strings[i] = offset < header->len ? request->payload + offset : "";
+            offset += strlen(*strings[i]) + 1;
+        }
+    }
+}
+
+int readIPCSocketRequest(IPCConnection* connection) {
+    const IPCRequestHeader* header = &connection->header;
+    while(true) {
+        ssize_t result;
+        if(connection->bytesRead < sizeof(IPCRequestHeader)) {
+            result = readIPCSocketRequestHeader(connection);
+            if(result > 0 && connection->bytesRead + result == sizeof(IPCRequestHeader)) {
+                if(!header->numCommands || header->numCommands > IPC_MAX_BATCH_SIZE ||
+                    header->len > header->numCommands * 3 * MAX_NAME_LEN) {
+                    WARN("Received malformed request on ipc socket");
+                    return -1;
+                }
+                connection->request.payload = malloc(header->len + 1);
+            }
+        }
+        else {
+            uint32_t payloadRead = connection->bytesRead - sizeof(IPCRequestHeader);
+            if(payloadRead == header->len) {
+                parseIPCSocketRequest(connection);
+                return 1;
+            }
+            result = recv(connection->fd, connection->request.payload + payloadRead, header->len - payloadRead, 0);
+        }
+        if(result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return 0;
+        if(result == -1 && errno == EINTR)
+            continue;
+        if(result <= 0) {
+            if(connection->bytesRead)
+                WARN("Received truncated request on ipc socket");
+            return -1;
+        }
+        connection->bytesRead += result;
+    }
+}
+
+int acceptIPCSocketConnection(int fd) {
+    int client = accept(fd, NULL, NULL);
+    if(client == -1) {
+        WARN("could not accept ipc connection");
+        return -1;
+    }
+    setCloseOnExec(client);
+    if(!isPeerTrusted(client)) {
+        close(client);
+        return -1;
+    }
+    fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+    return client;
+}
+
+void sendIPCSocketResponse(int fd, const int* statuses, uint32_t numCommands) {
+    int32_t buffer[numCommands];
+    for(int i = 0; i < numCommands; i++)
+        buffer[i] = statuses[i];
+    DEBUG("sending %d statuses over ipc socket %d", numCommands, fd);
+    if(write(fd, buffer, sizeof(buffer)) != sizeof(buffer))
+        WARN("could not send response over ipc socket");
+}
+
+void closeIPCSocketRequest(int fd, IPCRequest* request) {
+    if(request->outputFD != -1)
+        close(request->outputFD);
+    request->outputFD = -1;
+    free(request->commands);
+    free(request->payload);
+    request->commands = NULL;
+    request->payload = NULL;
+    close(fd);
+}
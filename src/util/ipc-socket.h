@@ -0,0 +1,181 @@
+/**
+ * @file ipc-socket.h
+ * UNIX socket transport used to send requests to the WM without round trips to the X server.
+ *
+ * A request is a header followed by the NUL terminated name, value and value2 of one or more commands.
+ * The client's stdout is passed along with the header so output can be written directly to it.
+ * The response is an int32_t exit code per command.
+ */
+#ifndef MPX_IPC_SOCKET_H_
+#define MPX_IPC_SOCKET_H_
+
+#include "../mywm-structs.h"
+
+/// max number of commands that can be sent in a single request
+#define IPC_MAX_BATCH_SIZE 1024
+/// max number of connections the WM will wait on to finish sending their request; the oldest is dropped when exceeded
+#define IPC_MAX_PENDING_CONNECTIONS 32
+
+/// Prefix of every request sent over the ipc socket
+typedef struct {
+    /// window or device id to run the options as; 0 for the active master
+    uint32_t active;
+    /// number of commands in the request
+    uint32_t numCommands;
+    /// number of bytes following the header; the NUL terminated name, value and value2 of each command
+    uint32_t len;
+} IPCRequestHeader;
+
+/// A single option to run
+typedef struct {
+    /// name of the option
+    const char* name;
+    /// first argument of the option or ""
+    const char* value;
+    /// second argument of the option or ""
+    const char* value2;
+} IPCCommand;
+
+/// A request read from the ipc socket
+typedef struct {
+    /// window or device id to run the options as; 0 for the active master
+    WindowID active;
+    /// the caller's stdout or -1
+    int outputFD;
+    /// number of commands in commands
+    uint32_t numCommands;
+    /// the commands to be run in order
+    IPCCommand* commands;
+    /// backing storage for the strings of commands
+    char* payload;
+} IPCRequest;
+
+/// A client connection whose request is read as it arrives
+typedef struct {
+    /// the connected, non-blocking socket
+    int fd;
+    /// number of bytes of the header and payload read so far
+    uint32_t bytesRead;
+    /// the header of the request; valid once it has been fully read
+    IPCRequestHeader header;
+    /// the request being read; valid once readIPCSocketRequest returns 1
+    IPCRequest request;
+} IPCConnection;
+
+/**
+ * @return the directory containing the ipc socket; $XDG_RUNTIME_DIR or a private, per user directory under /tmp
+ */
+const char* getIPCSocketDir(void);
+/**
+ * @return the path of the UNIX socket the WM listens on for requests
+ */
+const char* getIPCSocketPath(void);
+/**
+ * Creates and listens on a UNIX socket at getIPCSocketPath().
+ * A stale socket file left behind by a previous instance will be replaced.
+ * Nothing is created if the socket's directory is accessible by other users
+ *
+ * @return the listening fd or -1
+ */
+int createIPCSocket(void);
+/**
+ * Opens a connection to the ipc socket of the running WM
+ *
+ * @return the connected fd or -1 if the WM isn't listening or is run by a different user
+ */
+int connectToIPCSocket(void);
+/**
+ * Writes a request to fd. The caller's stdout is passed along, so the output of FORK_ON_RECEIVE options is written
+ * directly to it
+ *
+ * @param fd a connection returned from connectToIPCSocket
+ * @param name
+ * @param active
+ * @param value
+ * @param value2
+ *
+ * @return 0 iff the request was fully written
+ */
+int sendIPCSocketRequest(int fd, const char* name, WindowID active, const char* value, const char* value2);
+/**
+ * Like sendIPCSocketRequest but sends multiple commands that will be run together, in order, before the WM processes
+ * any other event
+ *
+ * @param fd a connection returned from connectToIPCSocket
+ * @param active
+ * @param commands
+ * @param numCommands
+ *
+ * @return 0 iff the request was fully written
+ */
+int sendIPCSocketBatchRequest(int fd, WindowID active, const IPCCommand* commands, uint32_t numCommands);
+/**
+ * Blocks until the WM responds to the request sent on fd
+ *
+ * @param fd
+ *
+ * @return the exit code of the request or WM_NOT_RESPONDING
+ */
+int receiveIPCSocketResponse(int fd);
+/**
+ * Blocks until the WM responds to the batch request sent on fd
+ *
+ * @param fd
+ * @param statuses filled with the exit code of each command
+ * @param numCommands the number of commands sent
+ *
+ * @return 0 iff a response was received
+ */
+int receiveIPCSocketBatchResponse(int fd, int* statuses, uint32_t numCommands);
+/**
+ * Sends a request over the ipc socket and waits for the response
+ *
+ * @return the exit code of the request or -1 if the WM isn't listening
+ */
+int sendOverIPCSocket(const char* name, WindowID active, const char* value, const char* value2);
+/**
+ * Sends a batch of commands over the ipc socket and waits for the response
+ *
+ * @param active
+ * @param commands
+ * @param numCommands
+ * @param statuses filled with the exit code of each command
+ *
+ * @return 0 on success, WM_NOT_RESPONDING if no response was received or -1 if the WM isn't listening
+ */
+int sendBatchOverIPCSocket(WindowID active, const IPCCommand* commands, uint32_t numCommands, int* statuses);
+
+/**
+ * Accepts a connection on the listening socket fd without reading from it.
+ * Connections from other users are rejected
+ *
+ * @param fd the fd returned by createIPCSocket
+ *
+ * @return the connected, non-blocking fd that the request should be read from or -1
+ */
+int acceptIPCSocketConnection(int fd);
+/**
+ * Reads whatever part of the request of connection is available without blocking
+ *
+ * @param connection a connection whose fd was returned by acceptIPCSocketConnection and whose request.outputFD is
+ * initially -1
+ *
+ * @return 1 once the request has been fully read, 0 if more data is needed or -1 on EOF, error or a malformed request
+ */
+int readIPCSocketRequest(IPCConnection* connection);
+/**
+ * Writes the exit code of each command of a request
+ *
+ * @param fd the fd returned by acceptIPCSocketConnection
+ * @param statuses
+ * @param numCommands
+ */
+void sendIPCSocketResponse(int fd, const int* statuses, uint32_t numCommands);
+/**
+ * Closes the connection and releases the resources of a request
+ *
+ * @param fd the fd returned by acceptIPCSocketConnection
+ * @param request
+ */
+void closeIPCSocketRequest(int fd, IPCRequest* request);
+#endif
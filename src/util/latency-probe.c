@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "latency-probe.h"
+#include "logger.h"
+#include "time.h"
+
+static bool enabled;
+/// the arrival time of the oldest device event whose requests have not been flushed; 0 if not armed
+static uint64_t armedTime;
+/// true if a request was made since the probe was armed
+static bool requestMade;
+
+static uint32_t histogram[LATENCY_HISTOGRAM_SIZE];
+static uint32_t numberOfSamples;
+static uint64_t totalLatency;
+static uint64_t maxLatency;
+
+void enableLatencyProbe(bool enable) {
+    enabled = enable;
+    armedTime = 0;
+    requestMade = 0;
+}
+bool isLatencyProbeEnabled(void) {
+    return enabled;
+}
+uint64_t getLatencyProbeTimestamp(void) {
+    return enabled ? getMicroTime() : 0;
+}
+void armLatencyProbe(uint64_t arrivalTime) {
+    if(!enabled || !arrivalTime)
+        return;
+    if(!armedTime || arrivalTime < armedTime)
+        armedTime = arrivalTime;
+}
+void markLatencyProbeRequest(void) {
+    if(armedTime)
+        requestMade = 1;
+}
+
+static int getBucket(uint64_t latency) {
+    int bucket = latency ? 63 - __builtin_clzll(latency) : 0;
+    return bucket < LATENCY_HISTOGRAM_SIZE ? bucket : LATENCY_HISTOGRAM_SIZE - 1;
+}
+void onLatencyProbeFlush(void) {
+    if(!armedTime)
+        return;
+    if(requestMade) {
+        uint64_t latency = getMicroTime() - armedTime;
+        TRACE("Input latency %lluus", (unsigned long long)latency);
+        histogram[getBucket(latency)]++;
+        numberOfSamples++;
+        totalLatency += latency;
+        if(latency > maxLatency)
+            maxLatency = latency;
+    }
+    armedTime = 0;
+    requestMade = 0;
+}
+
+uint32_t getLatencyHistogramCount(int bucket) {
+    return histogram[bucket];
+}
+uint32_t getNumberOfLatencySamples(void) {
+    return numberOfSamples;
+}
+uint64_t getMaxLatency(void) {
+    return maxLatency;
+}
+void resetLatencyHistogram(void) {
+    memset(histogram, 0, sizeof(histogram));
+    numberOfSamples = 0;
+    totalLatency = 0;
+    maxLatency = 0;
+}
+void printLatencyHistogram(void) {
+    printf("Input latency: %u samples; avg %lluus; max %lluus\n", numberOfSamples,
+        numberOfSamples ? (unsigned long long)(totalLatency / numberOfSamples) : 0ULL, (unsigned long long)maxLatency);
+    for(int i = 0; i < LATENCY_HISTOGRAM_SIZE; i++)
+        if(histogram[i])
+            printf("%8lluus - %8lluus: %u\n", i ? 1ULL << i : 0ULL, (1ULL << (i + 1)) - 1, histogram[i]);
+}
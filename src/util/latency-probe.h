@@ -0,0 +1,69 @@
+/**
+ * @file latency-probe.h
+ * @brief Measures the time from a device event arriving to the requests it triggered being flushed
+ *
+ * When enabled, onDeviceEvent timestamps each device event and checkBindings arms the probe with that timestamp
+ * before calling the matching binding. If the binding (or anything run before the next flush) configures a window or
+ * sets the input focus, the time between the event's arrival and the next flush is added to a histogram.
+ */
+#ifndef MPX_LATENCY_PROBE_H_
+#define MPX_LATENCY_PROBE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// number of buckets in the latency histogram; bucket i counts latencies in [2^i, 2^(i+1)) µs
+#define LATENCY_HISTOGRAM_SIZE 24
+
+/**
+ * @param enable if true, latencies will be measured and recorded
+ */
+void enableLatencyProbe(bool enable);
+/**
+ * @return 1 iff latencies are being measured
+ */
+bool isLatencyProbeEnabled(void);
+/**
+ * @return the time to be stored with a newly arrived device event or 0 if the probe is disabled
+ */
+uint64_t getLatencyProbeTimestamp(void);
+/**
+ * Starts tracking the requests triggered by the device event that arrived at arrivalTime.
+ * If a probe is already armed, the older timestamp is kept.
+ *
+ * @param arrivalTime the value of getLatencyProbeTimestamp when the event arrived
+ */
+void armLatencyProbe(uint64_t arrivalTime);
+/**
+ * Notes that a ConfigureWindow or SetInputFocus request was made.
+ * Called unconditionally; does nothing unless a probe is armed.
+ */
+void markLatencyProbeRequest(void);
+/**
+ * Called after requests are flushed to the X server.
+ * If a request was made since the probe was armed, the latency is recorded. In either case the probe is disarmed.
+ */
+void onLatencyProbeFlush(void);
+/**
+ * @param bucket
+ *
+ * @return the number of latencies recorded in [2^bucket, 2^(bucket+1)) µs
+ */
+uint32_t getLatencyHistogramCount(int bucket);
+/**
+ * @return the total number of latencies recorded
+ */
+uint32_t getNumberOfLatencySamples(void);
+/**
+ * @return the largest latency recorded (µs)
+ */
+uint64_t getMaxLatency(void);
+/**
+ * Clears all recorded latencies
+ */
+void resetLatencyHistogram(void);
+/**
+ * Prints the latency histogram to stdout
+ */
+void printLatencyHistogram(void);
+#endif
@@ -1,4 +1,11 @@
 #include <execinfo.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <assert.h>
@@ -7,7 +14,7 @@
 #include "../globals.h"
 #include "../system.h"
 #include "../xevent.h"
-#include "arraylist.h"
+#include "time.h"
 
 static LogLevel LOG_LEVEL = 0;
 
@@ -26,21 +33,248 @@ void printStackTrace(void) {
     backtrace_symbols_fd(array, size, STDOUT_FILENO);
 }
 
-ArrayList context;
-void pushContext(const char* c) {
-    addElement(&context, (char*)c);
-}
-void popContext() {
-    assert(context.size);
-    removeIndex(&context, context.size - 1);
-}
+const char* logContext[MAX_LOG_CONTEXT_DEPTH];
+uint32_t logContextDepth;
 
 int getEventQueueSize();
+int formatContextStr(char* buffer, int size) {
+    int len = snprintf(buffer, size, "%d|%04X|%04X|%04X|%04X|", RESTART_COUNTER, getCurrentSequenceNumber(),
+            getLastDetectedEventSequenceNumber(), getEventQueueSize(), getIdleCount());
+    for(int i = 0; i < logContextDepth && i < MAX_LOG_CONTEXT_DEPTH && len < size - 1; i++)
+        len += snprintf(buffer + len, size - len, "[%s]", logContext[i]);
+    if(logContextDepth > MAX_LOG_CONTEXT_DEPTH && len < size - 1)
+        len += snprintf(buffer + len, size - len, "[...]");
+    return len < size ? len : size - 1;
+}
 void printContextStr() {
-    // TODO
-    printf("%d|%04X|%04X|%04X|%04X|", RESTART_COUNTER, getCurrentSequenceNumber(), getLastDetectedEventSequenceNumber(),
-        getEventQueueSize(),
-        getIdleCount());
-    for(int i = 0; i < context.size; i++)
-        printf("[%s]", (char*)getElement(&context, i));
+    char buffer[LOG_ENTRY_LEN];
+    formatContextStr(buffer, sizeof(buffer));
+    printf("%s", buffer);
+}
+
+/// A formatted message waiting to be written by the logging thread
+typedef struct {
+    /// position in the queue this slot is ready for; see enqueueLogMessage
+    uint32_t sequence;
+    /// time (in ms) the message was logged
+    uint32_t timestamp;
+    /// the context str followed by the message
+    char message[LOG_ENTRY_LEN];
+} LogEntry;
+static LogEntry logBuffer[LOG_BUFFER_SIZE];
+/// the next position a producer will claim
+static uint32_t enqueuePos;
+/// the next position that will be written; claimed with a CAS by the logging thread or a signal handler
+static uint32_t dequeuePos;
+static uint32_t droppedMessages;
+static bool asyncLogging;
+static bool logThreadRunning;
+static pthread_t logThread;
+/// private copy of stdout taken when the logging thread was started; stdout may be temporarily redirected elsewhere
+static int logOutput = -1;
+
+uint32_t getNumberOfDroppedLogMessages(void) {
+    return __atomic_load_n(&droppedMessages, __ATOMIC_RELAXED);
+}
+bool isAsyncLogging(void) {
+    return __atomic_load_n(&asyncLogging, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Claims the next free slot of logBuffer. Slots are claimed with a CAS so multiple threads can log concurrently.
+ *
+ * @return the claimed slot or NULL if the buffer is full
+ */
+static LogEntry* claimLogEntry(uint32_t* pos) {
+    *pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+    while(true) {
+        LogEntry* entry = &logBuffer[*pos & (LOG_BUFFER_SIZE - 1)];
+        int32_t diff = (int32_t)(__atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE) - *pos);
+        if(diff == 0) {
+            if(__atomic_compare_exchange_n(&enqueuePos, pos, *pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                return entry;
+        }
+        else if(diff < 0)
+            return NULL;
+        else
+            *pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+    }
+}
+static void enqueueLogMessage(LogLevel level, const char* format, va_list args) {
+    uint32_t pos;
+    LogEntry* entry = claimLogEntry(&pos);
+    if(!entry && level >= LOG_LEVEL_WARN) {
+        for(int i = 0; !entry && i < LOG_FULL_BUFFER_TIMEOUT && isAsyncLogging(); i++) {
+            poll(NULL, 0, 1);
+            entry = claimLogEntry(&pos);
+        }
+    }
+    if(!entry) {
+        __atomic_add_fetch(&droppedMessages, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    entry->timestamp = getTime();
+    int len = formatContextStr(entry->message, LOG_ENTRY_LEN);
+    vsnprintf(entry->message + len, LOG_ENTRY_LEN - len, format, args);
+    __atomic_store_n(&entry->sequence, pos + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Claims the oldest fully enqueued message so that only one of the logging thread and a signal handler writes it.
+ *
+ * @return the claimed slot or NULL if there is nothing to write
+ */
+static LogEntry* claimQueuedLogEntry(uint32_t* pos) {
+    *pos = __atomic_load_n(&dequeuePos, __ATOMIC_ACQUIRE);
+    while(true) {
+        LogEntry* entry = &logBuffer[*pos & (LOG_BUFFER_SIZE - 1)];
+        if(__atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE) != *pos + 1)
+            return NULL;
+        if(__atomic_compare_exchange_n(&dequeuePos, pos, *pos + 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return entry;
+    }
+}
+/**
+ * Async-signal-safe conversion of value to decimal
+ *
+ * @return the number of characters written to buffer
+ */
+static int formatUInt(char* buffer, uint32_t value) {
+    char digits[10];
+    int len = 0;
+    do
+        digits[len++] = '0' + value % 10;
+    while(value /= 10);
+    for(int i = 0; i < len; i++)
+        buffer[i] = digits[len - 1 - i];
+    return len;
+}
+/**
+ * Writes a claimed entry with a single write(2), so it isn't interleaved with entries written by other threads,
+ * and then hands its slot back to the producers
+ *
+ * @return 0 iff the entry was written
+ */
+static int writeLogEntry(LogEntry* entry, uint32_t pos) {
+    char line[12 + LOG_ENTRY_LEN];
+    int len = formatUInt(line, entry->timestamp);
+    line[len++] = '|';
+    for(int i = 0; i < LOG_ENTRY_LEN && entry->message[i]; i++)
+        line[len++] = entry->message[i];
+    line[len++] = '\n';
+    int result = write(logOutput, line, len) == -1;
+    __atomic_store_n(&entry->sequence, pos + LOG_BUFFER_SIZE, __ATOMIC_RELEASE);
+    return result;
+}
+
+/**
+ * Writes every message that has been fully enqueued
+ *
+ * @return the number of messages written
+ */
+static int writeLogMessages(void) {
+    static uint32_t reportedDrops;
+    int count = 0;
+    uint32_t pos;
+    LogEntry* entry;
+    while((entry = claimQueuedLogEntry(&pos))) {
+        writeLogEntry(entry, pos);
+        count++;
+    }
+    uint32_t drops = getNumberOfDroppedLogMessages();
+    if(drops != reportedDrops) {
+        char buffer[64];
+        int len = snprintf(buffer, sizeof(buffer), "Dropped %u log messages\n", drops - reportedDrops);
+        if(write(logOutput, buffer, len) != -1)
+            reportedDrops = drops;
+    }
+    return count;
+}
+static void* logWriter(void* arg) {
+    while(true) {
+        bool running = isAsyncLogging();
+        if(!writeLogMessages()) {
+            if(!running)
+                break;
+            poll(NULL, 0, 5);
+        }
+    }
+    return NULL;
+}
+
+static void disableAsyncLoggingInChild(void) {
+    // the logging thread doesn't exist in the child and anything queued will be written by the parent
+    __atomic_store_n(&asyncLogging, 0, __ATOMIC_RELEASE);
+    logThreadRunning = 0;
+}
+void startAsyncLogging(void) {
+    static bool registered;
+    if(logThreadRunning)
+        return;
+    if(!registered) {
+        for(uint32_t i = 0; i < LOG_BUFFER_SIZE; i++)
+            logBuffer[i].sequence = i;
+        pthread_atfork(NULL, NULL, disableAsyncLoggingInChild);
+        atexit(stopAsyncLogging);
+        registered = 1;
+    }
+    fflush(stdout);
+    if((logOutput = dup(STDOUT_FILENO)) == -1) {
+        WARN("Could not duplicate stdout for the logging thread");
+        return;
+    }
+    fcntl(logOutput, F_SETFD, FD_CLOEXEC);
+    __atomic_store_n(&asyncLogging, 1, __ATOMIC_RELEASE);
+    // signals are handled by other threads so a handler never interrupts the writer while it holds an entry
+    sigset_t signals, oldSignals;
+    sigfillset(&signals);
+    pthread_sigmask(SIG_SETMASK, &signals, &oldSignals);
+    int result = pthread_create(&logThread, NULL, logWriter, NULL);
+    pthread_sigmask(SIG_SETMASK, &oldSignals, NULL);
+    if(result) {
+        __atomic_store_n(&asyncLogging, 0, __ATOMIC_RELEASE);
+        close(logOutput);
+        logOutput = -1;
+        WARN("Could not create logging thread");
+        return;
+    }
+    logThreadRunning = 1;
+}
+void stopAsyncLogging(void) {
+    if(!logThreadRunning)
+        return;
+    __atomic_store_n(&asyncLogging, 0, __ATOMIC_RELEASE);
+    pthread_join(logThread, NULL);
+    logThreadRunning = 0;
+    close(logOutput);
+    logOutput = -1;
+}
+
+void writeQueuedLogMessagesFromSignal(void) {
+    if(!logThreadRunning)
+        return;
+    __atomic_store_n(&asyncLogging, 0, __ATOMIC_RELEASE);
+    uint32_t pos;
+    LogEntry* entry;
+    while((entry = claimQueuedLogEntry(&pos)))
+        if(writeLogEntry(entry, pos))
+            break;
+    // give the logging thread a chance to finish writing the entry it may have claimed
+    pos = __atomic_load_n(&dequeuePos, __ATOMIC_ACQUIRE) - 1;
+    entry = &logBuffer[pos & (LOG_BUFFER_SIZE - 1)];
+    for(int i = 0; i < LOG_FULL_BUFFER_TIMEOUT && __atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE) == pos + 1; i++)
+        poll(NULL, 0, 1);
+}
+
+void logMessage(LogLevel level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    if(isAsyncLogging())
+        enqueueLogMessage(level, format, args);
+    else {
+        printContextStr();
+        vprintf(format, args);
+        printf("\n");
+    }
+    va_end(args);
 }
@@ -6,6 +6,9 @@
 #ifndef MPXMANAGER_LOGGER_H_
 #define MPXMANAGER_LOGGER_H_
 
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 /// various logging levels
@@ -51,9 +54,7 @@ typedef enum LogLevel {
 
 #define _LOG(LEVEL, str...) do { \
     if(isLogging(LEVEL)) {\
-        printContextStr();\
-        printf(str);\
-        printf("\n");\
+        logMessage(LEVEL, str);\
     }\
 }while(0)
 
@@ -78,6 +79,18 @@ typedef enum LogLevel {
 #define LOGGING 1
 #endif
 
+/// messages below this level are compiled out; ie -DMIN_LOG_LEVEL=LOG_LEVEL_WARN removes DEBUG and INFO messages
+#ifndef MIN_LOG_LEVEL
+#define MIN_LOG_LEVEL LOG_LEVEL_VERBOSE
+#endif
+
+/// number of messages the async log buffer can hold; must be a power of 2
+#define LOG_BUFFER_SIZE 1024
+/// max length of a single async log message (including the context prefix); longer messages are truncated
+#define LOG_ENTRY_LEN 256
+/// max time (in ms) a WARN or ERROR message will wait for space in a full log buffer before being dropped
+#define LOG_FULL_BUFFER_TIMEOUT 100
+
 /**
  * @return the current log level
  */
@@ -95,19 +108,88 @@ void setLogLevel(LogLevel level);
  * @return 1 if the message will be logged
  */
 static inline int isLogging(int i) {
-    return LOGGING && i >= getLogLevel();
+    return LOGGING && i >= MIN_LOG_LEVEL && i >= getLogLevel();
 }
+/**
+ * Logs a printf style message prefixed with the context str.
+ * If async logging is enabled the message is queued and written by the logging thread, else it is printed
+ * immediately.
+ *
+ * @param level
+ * @param format
+ * @param ... args of format
+ */
+void logMessage(LogLevel level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * Starts a thread that writes log messages so the caller of logMessage never blocks on stdout.
+ * The thread writes to a copy of stdout taken now, so temporarily redirecting stdout doesn't affect it.
+ * Messages are formatted by the caller and stored in a fixed size lock-free buffer.
+ * When the buffer is full, messages below LOG_LEVEL_WARN are dropped and counted while
+ * WARN and ERROR messages wait up to LOG_FULL_BUFFER_TIMEOUT ms for space.
+ *
+ * Async logging is disabled in forked children.
+ */
+void startAsyncLogging(void);
+/**
+ * Writes all queued messages and stops the logging thread. Subsequent messages will be printed synchronously.
+ * Does nothing if async logging isn't running.
+ */
+void stopAsyncLogging(void);
+/**
+ * Async-signal-safe alternative to stopAsyncLogging meant to be called right before the process exits or execs.
+ * Queued messages are written with write(2) and subsequent messages are printed synchronously, but the logging thread
+ * isn't joined. Each message is claimed before it is written so it is written exactly once by either this function
+ * or the logging thread.
+ */
+void writeQueuedLogMessagesFromSignal(void);
+/**
+ * @return 1 iff messages are being written by the logging thread
+ */
+bool isAsyncLogging(void);
+/**
+ * @return the number of messages that have been dropped because the async log buffer was full
+ */
+uint32_t getNumberOfDroppedLogMessages(void);
+/// max number of contexts that will be shown in log messages; deeper contexts are still tracked but elided
+#define MAX_LOG_CONTEXT_DEPTH 16
+/// if false, pushContext and popContext are no-ops; there is no need to track context when nothing is logged
+#define LOG_CONTEXT (LOGGING && MIN_LOG_LEVEL < LOG_LEVEL_NONE)
+/// the stack of contexts; only the first MAX_LOG_CONTEXT_DEPTH entries are valid
+extern const char* logContext[MAX_LOG_CONTEXT_DEPTH];
+/// number of contexts that have been pushed; may exceed MAX_LOG_CONTEXT_DEPTH
+extern uint32_t logContextDepth;
 /**
  * Adds to a list of messages that will be appending to all logging messages
  *
- * @param context name of the context
+ * @param context name of the context; must remain valid until the matching popContext
  */
-void pushContext(const char* context);
+static inline void pushContext(const char* context) {
+    if(LOG_CONTEXT) {
+        if(logContextDepth < MAX_LOG_CONTEXT_DEPTH)
+            logContext[logContextDepth] = context;
+        logContextDepth++;
+    }
+}
 /**
  * Removes the last context pushed via pushContext
  */
-void popContext();
+static inline void popContext() {
+    if(LOG_CONTEXT) {
+        assert(logContextDepth);
+        logContextDepth--;
+    }
+}
 
+/**
+ * Writes a string representation of everything on the context stack to buffer
+ *
+ * @param buffer
+ * @param size the size of buffer
+ *
+ * @return the number of characters written (excluding the NUL byte); at most size - 1
+ */
+int formatContextStr(char* buffer, int size);
 /**
  * prints a string representation of everything on the context stack
  */
@@ -0,0 +1,169 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <xcb/xcb.h>
+#include <xcb/xinput.h>
+
+#include "arraylist.h"
+#include "debug.h"
+#include "logger.h"
+#include "request-stats.h"
+
+/// max depth of nested events that will be tracked; deeper events are attributed to the outer most one tracked
+#define MAX_REQUEST_STATS_DEPTH 16
+
+/// Counts attributed to a single rule
+typedef struct {
+    const char* name;
+    RequestStats stats;
+} RuleRequestStats;
+
+/// The event being handled and the rule currently being applied for it
+typedef struct {
+    UserEvent type;
+    const char* rule;
+    /// lazily resolved stats of rule
+    RuleRequestStats* ruleStats;
+} RequestStatsFrame;
+
+static RequestStats eventStats[NUMBER_OF_MPX_EVENTS];
+static RequestStats totalStats;
+/// list of RuleRequestStats
+static ArrayList ruleStats;
+
+static RequestStatsFrame stack[MAX_REQUEST_STATS_DEPTH];
+/// number of events that have been pushed; may exceed MAX_REQUEST_STATS_DEPTH
+static uint32_t depth;
+/// number of hot path events among the tracked entries of stack
+static uint32_t hotPathDepth;
+static bool hotPathAssertions;
+
+static bool hotPaths[NUMBER_OF_MPX_EVENTS] = {
+    [XCB_CONFIGURE_NOTIFY] = 1,
+    [XCB_PROPERTY_NOTIFY] = 1,
+    [GENERIC_EVENT_OFFSET + XCB_INPUT_MOTION] = 1,
+};
+
+static RequestStatsFrame* getCurrentFrame(void) {
+    if(!depth)
+        return NULL;
+    return &stack[(depth < MAX_REQUEST_STATS_DEPTH ? depth : MAX_REQUEST_STATS_DEPTH) - 1];
+}
+
+void pushRequestStatsEvent(UserEvent type) {
+    if(depth < MAX_REQUEST_STATS_DEPTH) {
+        stack[depth] = (RequestStatsFrame) {.type = type};
+        if(hotPaths[type])
+            hotPathDepth++;
+    }
+    depth++;
+}
+void popRequestStatsEvent(void) {
+    assert(depth);
+    depth--;
+    if(depth < MAX_REQUEST_STATS_DEPTH && hotPaths[stack[depth].type] && hotPathDepth)
+        hotPathDepth--;
+}
+const char* setRequestStatsRule(const char* name) {
+    RequestStatsFrame* frame = getCurrentFrame();
+    if(!frame)
+        return NULL;
+    const char* lastRule = frame->rule;
+    frame->rule = name;
+    frame->ruleStats = NULL;
+    return lastRule;
+}
+
+static RuleRequestStats* findRuleStats(const char* name) {
+    FOR_EACH(RuleRequestStats*, rule, &ruleStats) {
+        if(rule->name == name || strcmp(rule->name, name) == 0)
+            return rule;
+    }
+    return NULL;
+}
+/**
+ * Calls func with every RequestStats the current request should be attributed to
+ */
+static void forEachActiveStats(void (*func)(RequestStats*, uint64_t), uint64_t value) {
+    func(&totalStats, value);
+    RequestStatsFrame* frame = getCurrentFrame();
+    if(!frame)
+        return;
+    func(&eventStats[frame->type], value);
+    if(frame->rule) {
+        if(!frame->ruleStats && !(frame->ruleStats = findRuleStats(frame->rule))) {
+            frame->ruleStats = calloc(1, sizeof(RuleRequestStats));
+            frame->ruleStats->name = frame->rule;
+            addElement(&ruleStats, frame->ruleStats);
+        }
+        func(&frame->ruleStats->stats, value);
+    }
+}
+static void addRequest(RequestStats* stats, uint64_t unused) {
+    stats->requests++;
+}
+static void addRoundTrip(RequestStats* stats, uint64_t blockedTime) {
+    stats->roundTrips++;
+    stats->blockedTime += blockedTime;
+}
+void countXRequest(void) {
+    forEachActiveStats(addRequest, 0);
+}
+void countRoundTrip(uint64_t blockedTime) {
+    forEachActiveStats(addRoundTrip, blockedTime);
+    if(hotPathAssertions && hotPathDepth) {
+        RequestStatsFrame* frame = getCurrentFrame();
+        ERROR("Synchronous round trip while handling hot path; event %s rule %s", eventTypeToString(frame->type),
+            frame->rule ? frame->rule : "none");
+        assert(0 && "synchronous round trip in hot path");
+    }
+}
+
+const RequestStats* getRequestStatsOfEvent(UserEvent type) {
+    return &eventStats[type];
+}
+const RequestStats* getRequestStatsOfRule(const char* name) {
+    RuleRequestStats* rule = findRuleStats(name);
+    return rule ? &rule->stats : NULL;
+}
+const RequestStats* getTotalRequestStats(void) {
+    return &totalStats;
+}
+void resetRequestStats(void) {
+    memset(eventStats, 0, sizeof(eventStats));
+    memset(&totalStats, 0, sizeof(totalStats));
+    FOR_EACH(RuleRequestStats*, rule, &ruleStats) {
+        free(rule);
+    }
+    clearArray(&ruleStats);
+    for(int i = 0; i < depth && i < MAX_REQUEST_STATS_DEPTH; i++)
+        stack[i].ruleStats = NULL;
+}
+
+void setHotPath(UserEvent type, bool hot) {
+    hotPaths[type] = hot;
+}
+bool isHotPath(UserEvent type) {
+    return hotPaths[type];
+}
+void enableHotPathAssertions(bool enable) {
+    hotPathAssertions = enable;
+}
+
+static void printStats(const char* name, const RequestStats* stats) {
+    printf("%-40s requests %8u round trips %8u blocked %10lluus\n", name, stats->requests, stats->roundTrips,
+        (unsigned long long)stats->blockedTime);
+}
+void printRequestStats(void) {
+    printStats("Total", &totalStats);
+    printf("Events:\n");
+    for(int i = 0; i < NUMBER_OF_MPX_EVENTS; i++)
+        if(eventStats[i].requests || eventStats[i].roundTrips)
+            printStats(eventTypeToString(i), &eventStats[i]);
+    printf("Rules:\n");
+    FOR_EACH(RuleRequestStats*, rule, &ruleStats) {
+        printStats(rule->name, &rule->stats);
+    }
+}
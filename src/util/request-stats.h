@@ -0,0 +1,108 @@
+/**
+ * @file request-stats.h
+ * @brief Counts X requests, reply waits and time blocked on replies per event type and rule
+ *
+ * applyEventRules and applyRules record which event and rule are active; XCALL and COUNT_ROUND_TRIP attribute
+ * requests and round trips to them. Certain events (motion, ConfigureNotify, PropertyNotify) are annotated as hot
+ * paths; when hot path assertions are enabled, any round trip made while handling them is fatal.
+ */
+#ifndef MPX_REQUEST_STATS_H_
+#define MPX_REQUEST_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../user-events.h"
+#include "time.h"
+
+/// Counts for a single event type or rule
+typedef struct {
+    /// number of requests sent
+    uint32_t requests;
+    /// number of times a reply (or error check) was waited for
+    uint32_t roundTrips;
+    /// total time spent waiting for replies (µs)
+    uint64_t blockedTime;
+} RequestStats;
+
+/**
+ * Evaluates EXPR, which is expected to wait for a reply, and counts it as a round trip
+ *
+ * @return the value of EXPR
+ */
+#define COUNT_ROUND_TRIP(EXPR) ({ \
+        uint64_t _roundTripStart = getMicroTime(); \
+        __typeof__(EXPR) _roundTripResult = EXPR; \
+        countRoundTrip(getMicroTime() - _roundTripStart); \
+        _roundTripResult;})
+
+/**
+ * Attributes all future requests to type until the matching popRequestStatsEvent
+ *
+ * @param type
+ */
+void pushRequestStatsEvent(UserEvent type);
+/**
+ * Restores the event that was active before the last pushRequestStatsEvent
+ */
+void popRequestStatsEvent(void);
+/**
+ * Attributes all future requests to the rule named name (as well as the current event)
+ *
+ * @param name the name of a BoundFunction; must remain valid while it is set
+ *
+ * @return the name of the previously active rule so it can be restored
+ */
+const char* setRequestStatsRule(const char* name);
+/**
+ * Notes that a request was sent
+ */
+void countXRequest(void);
+/**
+ * Notes that a reply was waited for
+ *
+ * @param blockedTime how long we waited (µs)
+ */
+void countRoundTrip(uint64_t blockedTime);
+/**
+ * @param type
+ *
+ * @return the counts attributed to type
+ */
+const RequestStats* getRequestStatsOfEvent(UserEvent type);
+/**
+ * @param name
+ *
+ * @return the counts attributed to the rule named name or NULL if nothing has been attributed to it
+ */
+const RequestStats* getRequestStatsOfRule(const char* name);
+/**
+ * @return the counts of everything
+ */
+const RequestStats* getTotalRequestStats(void);
+/**
+ * Clears all counts
+ */
+void resetRequestStats(void);
+/**
+ * Marks whether type is a hot path that shouldn't do synchronous round trips
+ *
+ * @param type
+ * @param hot
+ */
+void setHotPath(UserEvent type, bool hot);
+/**
+ * @param type
+ *
+ * @return 1 iff type is a hot path
+ */
+bool isHotPath(UserEvent type);
+/**
+ * @param enable if true, a round trip while handling a hot path will trigger an assert
+ */
+void enableHotPathAssertions(bool enable);
+/**
+ * Prints the counts of every event and rule that made a request or round trip to stdout
+ */
+void printRequestStats(void);
+#endif
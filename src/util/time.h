@@ -4,6 +4,7 @@
  */
 #ifndef MPXMANAGER_TIME_H_
 #define MPXMANAGER_TIME_H_
+#include <stdint.h>
 #include <time.h>
 #include <sys/time.h>
 /**
@@ -15,4 +16,12 @@ static inline unsigned int getTime() {
     gettimeofday(&start, NULL);
     return start.tv_sec * 1000 + start.tv_usec * 1e-3;
 }
+/**
+ * @return the current wall clock time (µs)
+ */
+static inline uint64_t getMicroTime() {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec * 1000000ULL + now.tv_usec;
+}
 #endif
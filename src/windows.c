@@ -16,6 +16,58 @@ static ArrayList windows;
 const ArrayList* getAllWindows(void) {
     return &windows;
 }
+///list of all windows marked as docks
+static ArrayList docks;
+const ArrayList* getAllDocks(void) {
+    return &docks;
+}
+void markAsDock(WindowInfo* winInfo) {
+    if(!winInfo->dock) {
+        winInfo->dock = 1;
+        addElement(&docks, winInfo);
+    }
+}
+
+/// The windows that are transient for a given window
+typedef struct {
+    /// the window the transients are for
+    WindowID parent;
+    /// list of WindowInfo* whose transientFor is parent
+    ArrayList transients;
+} TransientGroup;
+/// list of TransientGroup*; a group only exists while it has at least one transient
+static ArrayList transientGroups;
+const ArrayList* getTransientsOf(WindowID parent) {
+    static const ArrayList empty;
+    TransientGroup* group = findElement(&transientGroups, &parent, sizeof(WindowID));
+    return group ? &group->transients : &empty;
+}
+static void removeFromTransientGroup(WindowInfo* winInfo) {
+    TransientGroup* group = findElement(&transientGroups, &winInfo->transientFor, sizeof(WindowID));
+    if(!group)
+        return;
+    removeElementByPointer(&group->transients, winInfo);
+    if(!group->transients.size) {
+        removeElementByPointer(&transientGroups, group);
+        free(group);
+    }
+}
+void setTransientFor(WindowInfo* winInfo, WindowID parent) {
+    if(winInfo->transientFor == parent)
+        return;
+    if(winInfo->transientFor)
+        removeFromTransientGroup(winInfo);
+    winInfo->transientFor = parent;
+    if(!parent)
+        return;
+    TransientGroup* group = findElement(&transientGroups, &parent, sizeof(WindowID));
+    if(!group) {
+        group = malloc(sizeof(TransientGroup));
+        *group = (TransientGroup) {.parent = parent};
+        addElement(&transientGroups, group);
+    }
+    addElement(&group->transients, winInfo);
+}
 
 WindowInfo* newWindowInfo(WindowID id, WindowID parent) {
     WindowInfo* winInfo = malloc(sizeof(WindowInfo));
@@ -26,11 +78,13 @@ WindowInfo* newWindowInfo(WindowID id, WindowID parent) {
 }
 
 void freeWindowInfo(WindowInfo* winInfo) {
-    FOR_EACH(Master*, master, getAllMasters()) {
-        removeWindowFromFocusStack(master, winInfo->id);
-    }
+    removeWindowFromAllFocusStacks(winInfo);
     removeFromWorkspace(winInfo);
-    removeElement(&windows, winInfo, sizeof(WindowID));
+    if(winInfo->dock)
+        removeElementByPointer(&docks, winInfo);
+    if(winInfo->transientFor)
+        removeFromTransientGroup(winInfo);
+    removeElementByPointer(&windows, winInfo);
     free(winInfo);
 }
 
@@ -44,7 +98,7 @@ void removeFromWorkspace(WindowInfo* winInfo) {
     Workspace* w = getWorkspaceOfWindow(winInfo);
     if(w) {
         applyEventRules(WORKSPACE_WINDOW_REMOVE, winInfo);
-        removeIndex(getWorkspaceWindowStack(w), getIndex(getWorkspaceWindowStack(w), &winInfo->id, sizeof(WindowID)));
+        removeElementByPointer(getWorkspaceWindowStack(w), winInfo);
     }
 }
 
@@ -60,6 +114,8 @@ void moveToWorkspace(WindowInfo* winInfo, WorkspaceID destIndex) {
         DEBUG("Moving %d to workspace %d from %d", winInfo->id, destIndex, getWorkspaceIndexOfWindow(winInfo));
         removeFromWorkspace(winInfo);
         addElement(&getWorkspace(destIndex)->windows, winInfo);
+        if(hasMask(winInfo, MAPPED_MASK))
+            getWorkspace(destIndex)->mapped = 1;
         applyEventRules(WORKSPACE_WINDOW_ADD, winInfo);
     }
 }
@@ -27,13 +27,29 @@ typedef struct DockProperties {
     uint16_t end;
 } DockProperties;
 
+/**
+ * String properties of a window that are only loaded from the X server when first needed
+ * @see loadWindowStringProperties
+ */
+typedef enum WindowStringProperty {
+    /// className and instanceName
+    WINDOW_CLASS_PROPERTY = 1 << 0,
+    /// title
+    WINDOW_TITLE_PROPERTY = 1 << 1,
+    /// role
+    WINDOW_ROLE_PROPERTY = 1 << 2,
+    /// typeName
+    WINDOW_TYPE_NAME_PROPERTY = 1 << 3,
+    ALL_WINDOW_STRING_PROPERTIES = (1 << 4) - 1,
+} WindowStringProperty;
+
 ///holds data on a window
 struct WindowInfo {
     const WindowID id;
     /// the parent of this window
     WindowID parent;
     /**
-     * The window this window is a transient for
+     * The window this window is a transient for; should only be set via setTransientFor
      */
     WindowID transientFor;
     /**
@@ -58,15 +74,17 @@ struct WindowInfo {
     /**xcb_atom representing the window type*/
     uint32_t type;
 
-    /**string xcb_atom representing the window type*/
+    /// bitmask of WindowStringProperty that have been loaded since the last time they were marked stale
+    uint8_t loadedStringProperties;
+    /**string xcb_atom representing the window type; use getTypeName*/
     char typeName[MAX_NAME_LEN];
-    /**class name of window*/
+    /**class name of window; use getClassName*/
     char className[MAX_NAME_LEN];
-    /** instance name of window*/
+    /** instance name of window; use getInstanceName*/
     char instanceName[MAX_NAME_LEN];
-    /**title of window*/
+    /**title of window; use getTitle*/
     char title[MAX_NAME_LEN];
-    /** Application specified role of the window*/
+    /** Application specified role of the window; use getRole*/
     char role[MAX_NAME_LEN];
 
     ///time the window was last pinged
@@ -91,6 +109,8 @@ struct WindowInfo {
     /** The last know size of the window */
     Rect geometry;
     DockProperties dockProperties;
+    /// list of FocusNode*; one for each master whose focus stack contains this window
+    ArrayList focusNodes;
 };
 static inline void setGeometry(WindowInfo* winInfo, const short* s) { winInfo->geometry = *(Rect*)s;}
 
@@ -104,6 +124,26 @@ WindowInfo* newWindowInfo(WindowID id, WindowID parent);
  * Removes this window from Workspace & Master stack(s)
  */
 void freeWindowInfo(WindowInfo* winInfo);
+/**
+ * Marks winInfo as a dock and adds it to the list of docks
+ */
+void markAsDock(WindowInfo* winInfo);
+/**
+ * @return list of all windows marked as docks
+ */
+const ArrayList* getAllDocks(void);
+/**
+ * Sets the window winInfo is a transient for and updates the index used by getTransientsOf
+ *
+ * @param winInfo
+ * @param parent the window winInfo is transient for or 0
+ */
+void setTransientFor(WindowInfo* winInfo, WindowID parent);
+/**
+ * @param parent
+ * @return list of all windows whose transientFor is parent
+ */
+const ArrayList* getTransientsOf(WindowID parent);
 
 static inline bool isOverrideRedirectWindow(WindowInfo* winInfo) {return winInfo->overrideRedirect;};
 static inline bool isInputOnlyWindow(WindowInfo* winInfo) {return winInfo->inputOnly;};
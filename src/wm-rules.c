@@ -1,4 +1,10 @@
 #include <assert.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <xcb/xcbext.h>
 
 #include "bindings.h"
 #include "boundfunction.h"
@@ -6,12 +12,13 @@
 #include "xutil/device-grab.h"
 #include "globals.h"
 #include "layouts.h"
+#include "util/latency-probe.h"
 #include "util/logger.h"
 #include "masters.h"
 #include "monitors.h"
 #include "mywm-structs.h"
 #include "system.h"
-#include "time.h"
+#include "util/time.h"
 #include "user-events.h"
 #include "xutil/window-properties.h"
 #include "windows.h"
@@ -24,6 +31,7 @@ void initState() {
     addDefaultMaster();
     initCurrentMasters();
     assert(getActiveMaster() != NULL);
+    listenForMonitorChanges();
     detectMonitors();
 }
 void onXConnect(void) {
@@ -73,7 +81,7 @@ void onConfigureNotifyEvent(xcb_configure_notify_event_t* event) {
         applyEventRules(WINDOW_MOVE, winInfo);
     }
     if(event->window == root)
-        applyEventRules(SCREEN_CHANGE, NULL);
+        markMonitorsAsOutOfDate();
 }
 void onConfigureRequestEvent(xcb_configure_request_event_t* event) {
     short values[5];
@@ -116,7 +124,7 @@ void onDeviceEvent(xcb_input_key_press_event_t* event) {
     winInfo = getWindowInfo(list[i]);
     BindingEvent bindingEvent = {(Modifier)event->mods.effective, (Detail)event->detail, 1U << event->event_type,
                      (bool)((event->flags & XCB_INPUT_KEY_EVENT_FLAGS_KEY_REPEAT) ? 1 : 0),
-                     .winInfo = winInfo
+                     .winInfo = winInfo, .arrivalTime = getLatencyProbeTimestamp()
                  };
     applyEventRules(DEVICE_EVENT, &bindingEvent);
 }
@@ -146,6 +154,8 @@ void onMapEvent(xcb_map_notify_event_t* event) {
     if(winInfo) {
         bool alreadlyMapped = hasMask(winInfo, MAPPABLE_MASK);
         addMask(winInfo, MAPPABLE_MASK | MAPPED_MASK);
+        if(getWorkspaceOfWindow(winInfo))
+            getWorkspaceOfWindow(winInfo)->mapped = 1;
         if(!alreadlyMapped)
             applyEventRules(CLIENT_MAP_ALLOW, winInfo);
         if(winInfo->dock)
@@ -163,14 +173,210 @@ void onMapRequestEvent(xcb_map_request_event_t* event) {
     mapWindow(event->window);
 }
 
+static void loadTransientFor(WindowInfo* winInfo) {
+    xcb_window_t prop;
+    if(!xcb_icccm_get_wm_transient_for_reply(dis, xcb_icccm_get_wm_transient_for(dis, winInfo->id), &prop, NULL))
+        prop = 0;
+    setTransientFor(winInfo, prop);
+}
+
+uint32_t TITLE_REFRESH_INTERVAL = 100;
+/// A window whose title has changed since it was last loaded
+typedef struct {
+    WindowID id;
+    /// 1 iff the requests for the new title have been sent
+    bool requested;
+    /// 1 iff the title changed again after the requests were sent
+    bool changedAgain;
+    /// replies for _NET_WM_NAME and WM_NAME; valid iff requested
+    xcb_get_property_cookie_t cookies[2];
+    /// replies received so far; indexes match cookies
+    xcb_get_property_reply_t* replies[2];
+} PendingTitleRefresh;
+static ArrayList pendingTitleRefreshes;
+static uint32_t lastTitleRefreshTime;
+/// timer used to wake up the event loop to refresh titles or read the replies of property reloads
+static int refreshTimerFD = -1;
+
+static PendingTitleRefresh* getPendingTitleRefresh(WindowID win) {
+    FOR_EACH(PendingTitleRefresh*, pending, &pendingTitleRefreshes) {
+        if(pending->id == win)
+            return pending;
+    }
+    return NULL;
+}
+uint32_t getNumberOfPendingTitleRefreshes(void) {
+    return pendingTitleRefreshes.size;
+}
+static void markTitleChanged(WindowInfo* winInfo) {
+    // titles that were never read will be loaded with their latest value on first access
+    if(!(winInfo->loadedStringProperties & WINDOW_TITLE_PROPERTY))
+        return;
+    PendingTitleRefresh* pending = getPendingTitleRefresh(winInfo->id);
+    if(!pending) {
+        pending = calloc(1, sizeof(PendingTitleRefresh));
+        pending->id = winInfo->id;
+        addElement(&pendingTitleRefreshes, pending);
+    }
+    else if(pending->requested)
+        pending->changedAgain = 1;
+}
+/**
+ * @param pending
+ *
+ * @return 1 iff the replies to both title requests of pending have been received
+ */
+static bool pollTitleReplies(PendingTitleRefresh* pending) {
+    for(int i = 0; i < LEN(pending->cookies); i++)
+        if(!pending->replies[i]) {
+            xcb_generic_error_t* error = NULL;
+            if(!xcb_poll_for_reply(dis, pending->cookies[i].sequence, (void**)&pending->replies[i], &error))
+                return 0;
+            free(error);
+            // the window may no longer exist; treat it the same as an empty property
+            if(!pending->replies[i])
+                pending->replies[i] = calloc(1, sizeof(xcb_get_property_reply_t));
+        }
+    return 1;
+}
+static void applyTitleReplies(PendingTitleRefresh* pending) {
+    WindowInfo* winInfo = getWindowInfo(pending->id);
+    xcb_get_property_reply_t* reply = xcb_get_property_value_length(pending->replies[0]) ? pending->replies[0] :
+        pending->replies[1];
+    if(winInfo && (winInfo->loadedStringProperties & WINDOW_TITLE_PROPERTY)) {
+        int len = MIN_NAME_LEN(xcb_get_property_value_length(reply));
+        if(strncmp(winInfo->title, xcb_get_property_value(reply), len) || winInfo->title[len]) {
+            strncpy(winInfo->title, xcb_get_property_value(reply), len);
+            winInfo->title[len] = 0;
+            DEBUG("Title of window %d changed to '%s'", winInfo->id, winInfo->title);
+            applyEventRules(WINDOW_TITLE_CHANGE, winInfo);
+        }
+    }
+    for(int i = 0; i < LEN(pending->replies); i++) {
+        free(pending->replies[i]);
+        pending->replies[i] = NULL;
+    }
+}
+static uint32_t getTimeUntilNextTitleRefresh(void) {
+    uint32_t elapsed = getTime() - lastTitleRefreshTime;
+    return elapsed >= TITLE_REFRESH_INTERVAL ? 0 : TITLE_REFRESH_INTERVAL - elapsed;
+}
+void refreshChangedTitles(void) {
+    for(int i = pendingTitleRefreshes.size - 1; i >= 0; i--) {
+        PendingTitleRefresh* pending = getElement(&pendingTitleRefreshes, i);
+        if(!pending->requested || !pollTitleReplies(pending))
+            continue;
+        applyTitleReplies(pending);
+        pending->requested = 0;
+        if(!pending->changedAgain)
+            free(removeIndex(&pendingTitleRefreshes, i));
+        pending->changedAgain = 0;
+    }
+    if(!pendingTitleRefreshes.size || getTimeUntilNextTitleRefresh())
+        return;
+    lastTitleRefreshTime = getTime();
+    FOR_EACH(PendingTitleRefresh*, pending, &pendingTitleRefreshes) {
+        if(!pending->requested) {
+            TRACE("Requesting title of window %d", pending->id);
+            pending->cookies[0] = xcb_ewmh_get_wm_name(ewmh, pending->id);
+            pending->cookies[1] = xcb_icccm_get_wm_name(dis, pending->id);
+            pending->requested = 1;
+        }
+    }
+}
+/// A WM_HINTS or WM_TRANSIENT_FOR reload whose reply hasn't been read yet
+typedef struct {
+    WindowID id;
+    xcb_atom_t atom;
+    xcb_get_property_cookie_t cookie;
+} PendingPropertyReload;
+/// list of PendingPropertyReload in the order they were requested
+static ArrayList pendingPropertyReloads;
+
+/**
+ * Requests atom of winInfo without waiting for the reply; see applyPropertyReloads
+ */
+static void requestPropertyReload(WindowInfo* winInfo, xcb_atom_t atom) {
+    PendingPropertyReload* pending = malloc(sizeof(PendingPropertyReload));
+    *pending = (PendingPropertyReload) {.id = winInfo->id, .atom = atom,
+        .cookie = atom == XCB_ATOM_WM_HINTS ? xcb_icccm_get_wm_hints(dis, winInfo->id) :
+        xcb_icccm_get_wm_transient_for(dis, winInfo->id)
+    };
+    addElement(&pendingPropertyReloads, pending);
+}
+/**
+ * Applies the replies of property reloads that have arrived
+ */
+static void applyPropertyReloads(void) {
+    while(pendingPropertyReloads.size) {
+        PendingPropertyReload* pending = getHead(&pendingPropertyReloads);
+        xcb_get_property_reply_t* reply = NULL;
+        xcb_generic_error_t* error = NULL;
+        // replies arrive in order, so none of the later ones are ready either
+        if(!xcb_poll_for_reply(dis, pending->cookie.sequence, (void**)&reply, &error))
+            return;
+        free(error);
+        WindowInfo* winInfo = getWindowInfo(pending->id);
+        if(winInfo && reply) {
+            if(pending->atom == XCB_ATOM_WM_HINTS) {
+                xcb_icccm_wm_hints_t hints;
+                if(xcb_icccm_get_wm_hints_from_reply(&hints, reply))
+                    setWindowHints(winInfo, &hints);
+            }
+            else {
+                xcb_window_t prop;
+                setTransientFor(winInfo, xcb_icccm_get_wm_transient_for_from_reply(&prop, reply) ? prop : 0);
+            }
+        }
+        free(reply);
+        free(removeIndex(&pendingPropertyReloads, 0));
+    }
+}
+static void onRefreshTimer(int fd) {
+    uint64_t expirations;
+    if(read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+        applyPropertyReloads();
+        refreshChangedTitles();
+        flush();
+    }
+}
+/**
+ * Wakes up the event loop when the next batch of title requests can be sent.
+ * Replies to requests already sent may have been read into xcb's buffer while polling for events, in which case
+ * nothing would wake up the event loop, so while any are outstanding the timer is armed to check for them shortly.
+ */
+static void armRefreshTimer(void) {
+    bool waiting = 0;
+    bool awaitingReplies = pendingPropertyReloads.size;
+    FOR_EACH(PendingTitleRefresh*, pending, &pendingTitleRefreshes) {
+        if(pending->requested)
+            awaitingReplies = 1;
+        else
+            waiting = 1;
+    }
+    if(!waiting && !awaitingReplies)
+        return;
+    if(refreshTimerFD == -1) {
+        refreshTimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if(refreshTimerFD == -1) {
+            WARN("could not create timer to refresh titles");
+            return;
+        }
+        addExtraEvent(refreshTimerFD, POLLIN, onRefreshTimer);
+    }
+    uint32_t delay = awaitingReplies ? 1 : MAX(getTimeUntilNextTitleRefresh(), 1);
+    struct itimerspec spec = {.it_value = {.tv_sec = delay / 1000, .tv_nsec = (delay % 1000) * 1000000L}};
+    timerfd_settime(refreshTimerFD, 0, &spec, NULL);
+}
+
 void onPropertyEvent(xcb_property_notify_event_t* event) {
     WindowInfo* winInfo = getWindowInfo(event->window);
+    if(winInfo && (event->atom == ewmh->_NET_WM_NAME || event->atom == XCB_ATOM_WM_NAME))
+        markTitleChanged(winInfo);
     // only reload properties if a window is mapped
-    if(winInfo && hasMask(winInfo, MAPPED_MASK)) {
-        if(event->atom == ewmh->_NET_WM_NAME || event->atom == XCB_ATOM_WM_NAME)
-            getWindowTitle(winInfo->id, winInfo->title);
-        else if(event->atom == XCB_ATOM_WM_HINTS)
-            loadWindowHints(winInfo);
+    else if(winInfo && hasMask(winInfo, MAPPED_MASK)) {
+        if(event->atom == XCB_ATOM_WM_HINTS || event->atom == XCB_ATOM_WM_TRANSIENT_FOR)
+            requestPropertyReload(winInfo, event->atom);
     }
 }
 bool onSelectionClearEvent(xcb_selection_clear_event_t* event) {
@@ -233,11 +439,9 @@ void addNonDocksToActiveWorkspace(WindowInfo* winInfo) {
 
 void updateAllWindowWorkspaceState(int unmapped) {
     FOR_EACH(Workspace*, workspace, getAllWorkspaces()) {
-        if(isWorkspaceVisible(workspace) == !unmapped) {
-            FOR_EACH(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
-                updateWindowWorkspaceState(winInfo);
-            }
-        }
+        // invisible workspaces without any mapped windows are already in sync
+        if(isWorkspaceVisible(workspace) == !unmapped && (!unmapped || workspace->mapped))
+            updateWorkspaceMapState(workspace);
     }
 }
 void updateAllWindowInVisibleWorkspace() {
@@ -270,11 +474,8 @@ void assignDefaultLayoutsToWorkspace() {
 
 void loadWindowProperties(WindowInfo* winInfo) {
     TRACE("loading window properties %d", winInfo->id);
-    getClassInfo(winInfo->id, winInfo->className, winInfo->instanceName);
-    getWindowTitle(winInfo->id, winInfo->title);
-    xcb_window_t prop;
-    if(xcb_icccm_get_wm_transient_for_reply(dis, xcb_icccm_get_wm_transient_for(dis, winInfo->id), &prop, NULL))
-        winInfo->transientFor = prop;
+    markWindowStringPropertiesStale(winInfo, ALL_WINDOW_STRING_PROPERTIES);
+    loadTransientFor(winInfo);
     winInfo->type = getWindowType(winInfo->id);
     if(!winInfo->type) {
         TRACE("could not read window type; using default based on transient being set to %d",
@@ -282,14 +483,14 @@ void loadWindowProperties(WindowInfo* winInfo) {
         winInfo->type = winInfo->transientFor ? ewmh->_NET_WM_WINDOW_TYPE_DIALOG : ewmh->_NET_WM_WINDOW_TYPE_NORMAL;
         winInfo->implicitType = 1;
     }
-    getAtomName(winInfo->type, winInfo->typeName);
     // TODO loadProtocols(winInfo);
     loadWindowHints(winInfo);
     // TODO loadWindowSizeHints(winInfo);
-    getWindowPropertyString(winInfo->id, WM_WINDOW_ROLE, XCB_ATOM_STRING, winInfo->role);
+    // the rest are loaded on first access
+    loadWindowStringProperties(winInfo, getPrefetchedWindowStringProperties());
     if(winInfo->type == ewmh->_NET_WM_WINDOW_TYPE_DOCK) {
         DEBUG("Marking window as dock");
-        winInfo->dock = 1;
+        markAsDock(winInfo);
     }
 }
 
@@ -312,8 +513,10 @@ void addRememberMappedWindowsRule() {
 
 void addBasicRules() {
     addEvent(TRUE_IDLE, DEFAULT_EVENT(setIdleProperty, LOWER_PRIORITY));
+    addEvent(IDLE, DEFAULT_EVENT(refreshMonitorsIfOutOfDate, HIGHER_PRIORITY));
+    addEvent(IDLE, DEFAULT_EVENT(reapDetachedChildren, LOWEST_PRIORITY));
     addEvent(IDLE, DEFAULT_EVENT(applyBatchEventRules));
-    addEvent(0, DEFAULT_EVENT(logError));
+    addEvent(0, DEFAULT_EVENT(handleXError));
     addEvent(XCB_CREATE_NOTIFY, DEFAULT_EVENT(onCreateEvent));
     addEvent(XCB_DESTROY_NOTIFY, DEFAULT_EVENT(onDestroyEvent));
     addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(onUnmapEvent));
@@ -326,13 +529,14 @@ void addBasicRules() {
     addEvent(XCB_INPUT_FOCUS_IN + GENERIC_EVENT_OFFSET, DEFAULT_EVENT(onFocusInEvent));
     addEvent(XCB_INPUT_FOCUS_OUT + GENERIC_EVENT_OFFSET, DEFAULT_EVENT(onFocusOutEvent));
     addEvent(XCB_INPUT_HIERARCHY + GENERIC_EVENT_OFFSET, DEFAULT_EVENT(onHierarchyChangeEvent));
+    addEvent(EXTRA_EVENT, DEFAULT_EVENT(onRandrEvent));
     addEvent(X_CONNECTION, DEFAULT_EVENT(assignDefaultLayoutsToWorkspace, HIGHER_PRIORITY));
     addEvent(X_CONNECTION, DEFAULT_EVENT(initState, HIGHEST_PRIORITY));
     addEvent(X_CONNECTION, DEFAULT_EVENT(assignUnusedMonitorsToWorkspaces, HIGH_PRIORITY));
     addEvent(X_CONNECTION, DEFAULT_EVENT(onXConnect, HIGH_PRIORITY));
     addEvent(CLIENT_MAP_ALLOW, DEFAULT_EVENT(loadWindowProperties, HIGHER_PRIORITY));
     addEvent(POST_REGISTER_WINDOW, DEFAULT_EVENT(listenForNonRootEventsFromWindow, HIGHER_PRIORITY));
-    addBatchEvent(SCREEN_CHANGE, DEFAULT_EVENT(detectMonitors, HIGH_PRIORITY));
+    addBatchEvent(SCREEN_CHANGE, DEFAULT_EVENT(removeDuplicateMonitors, HIGH_PRIORITY));
     addBatchEvent(SCREEN_CHANGE, DEFAULT_EVENT(resizeAllMonitorsToAvoidAllDocks));
     addBatchEvent(SCREEN_CHANGE, DEFAULT_EVENT(assignUnusedMonitorsToWorkspaces, LOW_PRIORITY));
     for(int i = XCB_INPUT_KEY_PRESS; i <= XCB_INPUT_MOTION; i++) {
@@ -343,6 +547,9 @@ void addBasicRules() {
     addApplyBindingsRule(remove);
     addIgnoreOverrideRedirectAndInputOnlyWindowsRule();
     addSyncMapStateRules();
+    addEvent(IDLE, DEFAULT_EVENT(applyPropertyReloads));
+    addEvent(IDLE, DEFAULT_EVENT(refreshChangedTitles));
+    addEvent(TRUE_IDLE, DEFAULT_EVENT(armRefreshTimer));
 }
 
 bool ignoreOverrideRedirectAndInputOnlyWindowWindowsRule(WindowInfo* winInfo) {
@@ -16,6 +16,22 @@
  */
 void loadWindowProperties(WindowInfo* winInfo);
 
+/// Minimum time (ms) between batches of requests to reload changed window titles
+extern uint32_t TITLE_REFRESH_INTERVAL;
+/**
+ * Reads the replies of any outstanding title requests and, if TITLE_REFRESH_INTERVAL has passed since the last
+ * batch, requests the titles of all windows whose title changed since.
+ *
+ * Titles that have been loaded are only marked as changed on PropertyNotify so that clients which rapidly update
+ * their title cost at most one set of requests per TITLE_REFRESH_INTERVAL. Replies are only read once they have
+ * arrived and WINDOW_TITLE_CHANGE is triggered once per refresh that changed the title.
+ */
+void refreshChangedTitles(void);
+/**
+ * @return the number of windows whose title has changed but hasn't been reloaded yet
+ */
+uint32_t getNumberOfPendingTitleRefreshes(void);
+
 /**
  * Adds onDeviceEvent for the appropriate rules
  */
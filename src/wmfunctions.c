@@ -17,6 +17,7 @@
 #include "monitors.h"
 #include "threads.h"
 #include "user-events.h"
+#include "util/latency-probe.h"
 #include "util/logger.h"
 #include "util/time.h"
 #include "xutil/window-properties.h"
@@ -133,12 +134,14 @@ static bool focusNextVisibleWindow(Master* master, WindowInfo* ignore) {
         focusWindowInfoAsMaster(getFocusedWindowOfMaster(master), master)) {
         return 1;
     }
-    FOR_EACH(WindowInfo*, winInfo, getMasterWindowStack(master)) {
+    for(FocusNode* node = master->focusStackHead; node; node = node->next) {
+        WindowInfo* winInfo = node->winInfo;
         if(winInfo != ignore && getMasterWorkspaceIndex(master) == getWorkspaceIndexOfWindow(winInfo) && isFocusable(winInfo) &&
             focusWindowInfoAsMaster(winInfo, master))
             return 1;
     }
-    FOR_EACH(WindowInfo*, winInfo, getMasterWindowStack(master)) {
+    for(FocusNode* node = master->focusStackHead; node; node = node->next) {
+        WindowInfo* winInfo = node->winInfo;
         if(winInfo != ignore && isNotInInvisibleWorkspace(winInfo) && isFocusable(winInfo) &&
             focusWindowInfoAsMaster(winInfo, master))
             return 1;
@@ -172,19 +175,24 @@ bool unregisterWindow(WindowInfo* winInfo, bool unregisterForEvents) {
 }
 
 /**
+ * @param winInfo
+ * @param workspace the workspace of winInfo
+ *
  * @return 1 iff whether the window is mapped doesn't match if its workspace is visible
  */
-static inline bool isOutOfSyncWithWorkspace(WindowInfo* winInfo) {
-    return getWorkspaceOfWindow(winInfo) ? isWorkspaceVisible(getWorkspaceOfWindow(winInfo)) ^
-        (hasAndHasNotMasks(winInfo, MAPPED_MASK, HIDDEN_MASK)) : 0;
+static inline bool isOutOfSyncWithWorkspace(WindowInfo* winInfo, Workspace* workspace) {
+    return workspace ? isWorkspaceVisible(workspace) ^ (hasAndHasNotMasks(winInfo, MAPPED_MASK, HIDDEN_MASK)) : 0;
 }
 
-void updateWindowWorkspaceState(WindowInfo* winInfo) {
-    if(!isOutOfSyncWithWorkspace(winInfo))
+/**
+ * @copydoc updateWindowWorkspaceState
+ * @param workspace the workspace of winInfo; passed in to avoid searching every workspace for winInfo
+ */
+static void syncWindowWithWorkspace(WindowInfo* winInfo, Workspace* workspace) {
+    if(!isOutOfSyncWithWorkspace(winInfo, workspace))
         return;
-    DEBUG("updating window workspace state: Visible: %d; Window: %d", isWorkspaceVisible(getWorkspaceOfWindow(winInfo)),
-        winInfo->id);
-    if(isNotInInvisibleWorkspace(winInfo) && isMappable(winInfo)) {
+    DEBUG("updating window workspace state: Visible: %d; Window: %d", isWorkspaceVisible(workspace), winInfo->id);
+    if(isWorkspaceVisible(workspace) && isMappable(winInfo)) {
         if(!hasMask(winInfo, MAPPED_MASK)) {
             mapWindow(winInfo->id);
             addMask(winInfo, MAPPABLE_MASK | MAPPED_MASK);
@@ -196,6 +204,17 @@ void updateWindowWorkspaceState(WindowInfo* winInfo) {
         removeMask(winInfo, MAPPED_MASK);
     }
 }
+void updateWindowWorkspaceState(WindowInfo* winInfo) {
+    syncWindowWithWorkspace(winInfo, getWorkspaceOfWindow(winInfo));
+}
+void updateWorkspaceMapState(Workspace* workspace) {
+    bool mapped = 0;
+    FOR_EACH(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
+        syncWindowWithWorkspace(winInfo, workspace);
+        mapped |= hasMask(winInfo, MAPPED_MASK);
+    }
+    workspace->mapped = mapped;
+}
 
 void switchToWorkspace(int workspaceIndex) {
     if(!isWorkspaceVisible(getWorkspace(workspaceIndex))) {
@@ -225,9 +244,9 @@ void switchToWorkspace(int workspaceIndex) {
 
 void activateWorkspace(WorkspaceID workspaceIndex) {
     switchToWorkspace(workspaceIndex);
-    FOR_EACH(WindowInfo*, winInfo, getActiveMasterWindowStack()) {
-        if(getWorkspaceIndexOfWindow(winInfo) == workspaceIndex) {
-            activateWindow(winInfo);
+    for(FocusNode* node = getActiveMaster()->focusStackHead; node; node = node->next) {
+        if(getWorkspaceIndexOfWindow(node->winInfo) == workspaceIndex) {
+            activateWindow(node->winInfo);
             return;
         }
     }
@@ -263,7 +282,8 @@ void configureWindow(WindowID win, uint32_t mask, uint32_t values[7]) {
     assert(mask < 128);
     INFO("Config %d: mask %d (%d bits)", win, mask, __builtin_popcount(mask));
     LOG_RUN(LOG_LEVEL_INFO, PRINT_ARR("Config values", values, __builtin_popcount(mask)));
-    XCALL(xcb_configure_window, dis, win, mask, values);
+    xBackend->configureWindow(win, mask, values);
+    markLatencyProbeRequest();
 }
 void setWindowPosition(WindowID win, const Rect geo) {
     uint32_t values[4];
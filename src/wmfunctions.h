@@ -68,6 +68,13 @@ bool unregisterWindow(WindowInfo* winInfo, bool destroyed) ;
  * @param winInfo
  */
 void updateWindowWorkspaceState(WindowInfo* winInfo);
+/**
+ * Updates the map state of every window in workspace to be in sync with workspace and
+ * records in workspace->mapped whether any of them are still mapped
+ *
+ * @param workspace
+ */
+void updateWorkspaceMapState(Workspace* workspace);
 /**
  * For all masters focused on winInfoToIgnore, the focus will be shifted to the
  * first focusable window in the window stack not including winInfoToIgnore.
@@ -35,6 +35,8 @@ void freeWorkspace(Workspace* workspace) {
     }
     clearArray(&workspace->windows);
     clearArray(&workspace->layouts);
+    if(workspace->monitor && workspace->monitor->workspace == workspace)
+        workspace->monitor->workspace = NULL;
     free(workspace);
 }
 void removeWorkspaces(int num) {
@@ -50,6 +52,16 @@ Monitor* getMonitor(Workspace* workspace) {
 }
 void setMonitor(Workspace* workspace, Monitor* m) {
     if(m != workspace->monitor) {
+        // docks in workspaces only apply to the monitor their workspace is on
+        if(workspace->monitor) {
+            workspace->monitor->viewDirty = 1;
+            if(workspace->monitor->workspace == workspace)
+                workspace->monitor->workspace = NULL;
+        }
+        if(m) {
+            m->viewDirty = 1;
+            m->workspace = workspace;
+        }
         workspace->monitor = m;
         applyEventRules(MONITOR_WORKSPACE_CHANGE, workspace);
     }
@@ -48,10 +48,10 @@ struct Workspace {
     ///the monitor the workspace is on
     Monitor* monitor;
 
-    /** if the workspace is mapped
+    /** if the workspace may contain mapped windows
      *
      * A workspace should be mapped when it is visible, but assigning a monitor does not does not automatically cause all windows in the workspace to be mapped.
-     * This field is here to sync the two states
+     * This field is here to sync the two states; invisible workspaces that aren't mapped are skipped when syncing
      *
      */
     bool mapped ;
@@ -8,6 +8,7 @@
 #include <X11/Xlib-xcb.h>
 
 #include "boundfunction.h"
+#include "event-recorder.h"
 #include "globals.h"
 #include "monitors.h"
 #include "user-events.h"
@@ -75,13 +76,20 @@ void addExtraEvent(int fd, int mask,  void(*callBack)()) {
     eventFDInfo.pollFDs[index] = (struct pollfd) {fd, mask};
     eventFDInfo.extraEventCallBacks[index] = callBack;
 }
-static void removeExtraEvent(int index) {
+static void removeExtraEventAtIndex(int index) {
     for(int i = index + 1; i < eventFDInfo.numberOfFDsToPoll; i++) {
         eventFDInfo.pollFDs[i - 1] = eventFDInfo.pollFDs[i];
         eventFDInfo.extraEventCallBacks[i - 1] = eventFDInfo.extraEventCallBacks[i];
     }
     eventFDInfo.numberOfFDsToPoll--;
 }
+void removeExtraEvent(int fd) {
+    for(int i = 1; i < eventFDInfo.numberOfFDsToPoll; i++)
+        if(eventFDInfo.pollFDs[i].fd == fd) {
+            removeExtraEventAtIndex(i);
+            return;
+        }
+}
 
 static inline int processEvents(int timeout) {
     int numEvents;
@@ -90,13 +98,16 @@ static inline int processEvents(int timeout) {
     if((numEvents = poll(eventFDInfo.pollFDs, eventFDInfo.numberOfFDsToPoll, timeout))) {
         TRACE("FD poll returned %d events out of %d", numEvents, eventFDInfo.numberOfFDsToPoll);
         for(int i = eventFDInfo.numberOfFDsToPoll - 1; i >= 0; i--) {
-            if(eventFDInfo.pollFDs[i].revents) {
-                if(eventFDInfo.pollFDs[i].revents & eventFDInfo.pollFDs[i].events) {
-                    eventFDInfo.extraEventCallBacks[i](eventFDInfo.pollFDs[i].fd, eventFDInfo.pollFDs[i].revents);
+            struct pollfd pollFD = eventFDInfo.pollFDs[i];
+            if(pollFD.revents) {
+                if(pollFD.revents & pollFD.events) {
+                    eventFDInfo.extraEventCallBacks[i](pollFD.fd, pollFD.revents);
                 }
-                if(eventFDInfo.pollFDs[i].revents & (POLLERR | POLLNVAL | POLLHUP)) {
+                // the callback may have already removed its fd
+                if(pollFD.revents & (POLLERR | POLLNVAL | POLLHUP) && i < eventFDInfo.numberOfFDsToPoll &&
+                    eventFDInfo.pollFDs[i].fd == pollFD.fd) {
                     WARN("Removing extra event index %d", i);
-                    removeExtraEvent(i);
+                    removeExtraEventAtIndex(i);
                 }
             }
         }
@@ -129,6 +140,8 @@ void processXEvent(xcb_generic_event_t* event) {
     // TODO pre event processing rule
     type = type < LASTEvent ? type : EXTRA_EVENT;
     lastEventSequenceNumber = event->sequence;
+    if(isRecordingEvents())
+        recordEvent(event);
     applyEventRules(type, event);
     free(event);
 #ifdef DEBUG
@@ -163,6 +176,8 @@ void runEventLoop() {
         if(processEvents(IDLE_TIMEOUT)) {
             continue;
         }
+        if(isRecordingEvents())
+            recordIdle();
         applyEventRules(IDLE, NULL);
         flush();
         if(pushEvent(xcb_poll_for_queued_event(dis))) {
@@ -12,6 +12,12 @@
 
 
 void addExtraEvent(int fd, int mask,  void(*callBack)());
+/**
+ * Stops polling fd; safe to call from the callback of fd. Should be called before fd is closed.
+ *
+ * @param fd a fd passed to addExtraEvent
+ */
+void removeExtraEvent(int fd);
 
 void setIdleProperty();
 void addXIEventSupport();
@@ -38,6 +44,12 @@ uint32_t getLastDetectedEventSequenceNumber();
  * This method will only exit when the x connection is lost
  */
 void runEventLoop();
+/**
+ * Applies the rules corresponding to event and frees it
+ *
+ * @param event an event returned by xcb
+ */
+void processXEvent(xcb_generic_event_t* event);
 /**
  * To be called when a generic event is received
  * loads info related to the generic event which can be accessed by getLastEvent()
@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../util/arraylist.h"
+#include "../util/logger.h"
+#include "fake-x-backend.h"
+
+/// A property stored by fakeXBackend
+typedef struct {
+    xcb_atom_t atom;
+    xcb_atom_t type;
+    uint8_t format;
+    /// the size of data in bytes
+    uint32_t size;
+    char data[];
+} FakeProperty;
+
+/// The state of a window as seen by fakeXBackend
+typedef struct {
+    WindowID id;
+    bool mapped;
+    /// the mask of the last configure request
+    uint16_t mask;
+    /// the values of the last configure request
+    uint32_t values[7];
+    /// list of FakeProperty
+    ArrayList properties;
+} FakeWindow;
+
+static ArrayList fakeWindows;
+static uint32_t requestCounts[NUMBER_OF_X_BACKEND_REQUESTS];
+static int grabStatus;
+
+uint32_t getFakeXRequestCount(XBackendRequest type) {
+    return requestCounts[type];
+}
+uint32_t getTotalFakeXRequestCount(void) {
+    uint32_t total = 0;
+    for(int i = 0; i < NUMBER_OF_X_BACKEND_REQUESTS; i++)
+        total += requestCounts[i];
+    return total;
+}
+void resetFakeXRequestCounts(void) {
+    memset(requestCounts, 0, sizeof(requestCounts));
+}
+void setFakeXGrabStatus(int status) {
+    grabStatus = status;
+}
+
+static FakeWindow* findFakeWindow(WindowID win) {
+    FOR_EACH(FakeWindow*, fakeWindow, &fakeWindows) {
+        if(fakeWindow->id == win)
+            return fakeWindow;
+    }
+    return NULL;
+}
+static FakeWindow* getFakeWindow(WindowID win) {
+    FakeWindow* fakeWindow = findFakeWindow(win);
+    if(!fakeWindow) {
+        fakeWindow = calloc(1, sizeof(FakeWindow));
+        fakeWindow->id = win;
+        addElement(&fakeWindows, fakeWindow);
+    }
+    return fakeWindow;
+}
+static FakeProperty* findFakeProperty(FakeWindow* fakeWindow, xcb_atom_t atom) {
+    FOR_EACH(FakeProperty*, property, &fakeWindow->properties) {
+        if(property->atom == atom)
+            return property;
+    }
+    return NULL;
+}
+static void clearFakeXState(void) {
+    FOR_EACH(FakeWindow*, fakeWindow, &fakeWindows) {
+        FOR_EACH(FakeProperty*, property, &fakeWindow->properties) {
+            free(property);
+        }
+        clearArray(&fakeWindow->properties);
+        free(fakeWindow);
+    }
+    clearArray(&fakeWindows);
+    resetFakeXRequestCounts();
+    grabStatus = 0;
+}
+void useFakeXBackend(void) {
+    clearFakeXState();
+    setXBackend(&fakeXBackend);
+}
+void useXCBBackend(void) {
+    clearFakeXState();
+    setXBackend(&xcbBackend);
+}
+
+bool isFakeWindowMapped(WindowID win) {
+    FakeWindow* fakeWindow = findFakeWindow(win);
+    return fakeWindow && fakeWindow->mapped;
+}
+const uint32_t* getFakeWindowConfig(WindowID win, uint16_t* mask) {
+    FakeWindow* fakeWindow = findFakeWindow(win);
+    if(!fakeWindow || !fakeWindow->mask)
+        return NULL;
+    if(mask)
+        *mask = fakeWindow->mask;
+    return fakeWindow->values;
+}
+
+static void fakeConfigureWindow(WindowID win, uint16_t mask, const uint32_t* values) {
+    requestCounts[X_CONFIGURE_WINDOW]++;
+    FakeWindow* fakeWindow = getFakeWindow(win);
+    fakeWindow->mask = mask;
+    memcpy(fakeWindow->values, values, sizeof(uint32_t) * __builtin_popcount(mask));
+}
+static void fakeMapWindow(WindowID win) {
+    requestCounts[X_MAP_WINDOW]++;
+    getFakeWindow(win)->mapped = 1;
+}
+static void fakeUnmapWindow(WindowID win) {
+    requestCounts[X_UNMAP_WINDOW]++;
+    getFakeWindow(win)->mapped = 0;
+}
+static void fakeChangeProperty(WindowID win, xcb_atom_t atom, xcb_atom_t type, uint8_t format, uint32_t len,
+    const void* data) {
+    requestCounts[X_CHANGE_PROPERTY]++;
+    FakeWindow* fakeWindow = getFakeWindow(win);
+    FakeProperty* property = findFakeProperty(fakeWindow, atom);
+    if(property)
+        free(removeElementByPointer(&fakeWindow->properties, property));
+    uint32_t size = len * (format / 8);
+    property = malloc(sizeof(FakeProperty) + size);
+    *property = (FakeProperty) {.atom = atom, .type = type, .format = format, .size = size};
+    memcpy(property->data, data, size);
+    addElement(&fakeWindow->properties, property);
+}
+static void fakeDeleteProperty(WindowID win, xcb_atom_t atom) {
+    requestCounts[X_DELETE_PROPERTY]++;
+    FakeWindow* fakeWindow = findFakeWindow(win);
+    FakeProperty* property = fakeWindow ? findFakeProperty(fakeWindow, atom) : NULL;
+    if(property)
+        free(removeElementByPointer(&fakeWindow->properties, property));
+}
+static xcb_get_property_reply_t* fakeGetProperty(WindowID win, xcb_atom_t atom, xcb_atom_t type) {
+    requestCounts[X_GET_PROPERTY]++;
+    FakeWindow* fakeWindow = findFakeWindow(win);
+    FakeProperty* property = fakeWindow ? findFakeProperty(fakeWindow, atom) : NULL;
+    if(!property || !property->size || type != XCB_GET_PROPERTY_TYPE_ANY && type != property->type)
+        return NULL;
+    // the value of the property immediately follows the reply; see xcb_get_property_value
+    xcb_get_property_reply_t* reply = calloc(1, sizeof(xcb_get_property_reply_t) + property->size);
+    reply->response_type = XCB_GET_PROPERTY;
+    reply->format = property->format;
+    reply->type = property->type;
+    reply->value_len = property->size / (property->format / 8);
+    reply->length = (property->size + 3) / 4;
+    memcpy(reply + 1, property->data, property->size);
+    return reply;
+}
+static int fakeGrabDevice(MasterID deviceID, uint32_t maskValue) {
+    requestCounts[X_GRAB_DEVICE]++;
+    return grabStatus;
+}
+static int fakeUngrabDevice(MasterID deviceID) {
+    requestCounts[X_UNGRAB_DEVICE]++;
+    return 0;
+}
+static int fakeGrabDetail(MasterID deviceID, uint32_t detail, uint32_t mod, uint32_t maskValue, uint32_t ignoreMod) {
+    requestCounts[X_GRAB_DETAIL]++;
+    return grabStatus;
+}
+static int fakeUngrabDetail(MasterID deviceID, uint32_t detail, uint32_t mod, uint32_t ignoreMod, bool isKeyboard) {
+    requestCounts[X_UNGRAB_DETAIL]++;
+    return 0;
+}
+
+const XBackend fakeXBackend = {
+    .configureWindow = fakeConfigureWindow,
+    .mapWindow = fakeMapWindow,
+    .unmapWindow = fakeUnmapWindow,
+    .changeProperty = fakeChangeProperty,
+    .deleteProperty = fakeDeleteProperty,
+    .getProperty = fakeGetProperty,
+    .grabDevice = fakeGrabDevice,
+    .ungrabDevice = fakeUngrabDevice,
+    .grabDetail = fakeGrabDetail,
+    .ungrabDetail = fakeUngrabDetail,
+};
@@ -0,0 +1,58 @@
+/**
+ * @file fake-x-backend.h
+ * @brief An XBackend that never talks to the X server
+ *
+ * Requests are counted and properties are stored in memory so that they can be read back by getWindowProperty.
+ * This allows core logic to be tested and benchmarked without a display and tests to assert the exact number of
+ * requests an operation issues.
+ */
+#ifndef MPX_FAKE_X_BACKEND_H_
+#define MPX_FAKE_X_BACKEND_H_
+
+#include "x-backend.h"
+
+/// Counts requests and stores properties in memory
+extern const XBackend fakeXBackend;
+
+/**
+ * Clears all state of the fake backend and routes all requests through it
+ */
+void useFakeXBackend(void);
+/**
+ * Clears all state of the fake backend and routes all requests back to the X server
+ */
+void useXCBBackend(void);
+/**
+ * @param type
+ *
+ * @return the number of requests of type that have been made to fakeXBackend since the last reset
+ */
+uint32_t getFakeXRequestCount(XBackendRequest type);
+/**
+ * @return the total number of requests that have been made to fakeXBackend since the last reset
+ */
+uint32_t getTotalFakeXRequestCount(void);
+/**
+ * Zeros all request counts
+ */
+void resetFakeXRequestCounts(void);
+/**
+ * Sets the value fakeXBackend will return for future grab requests
+ *
+ * @param status 0 for success
+ */
+void setFakeXGrabStatus(int status);
+/**
+ * @param win
+ *
+ * @return 1 iff win was last mapped (as opposed to unmapped) by fakeXBackend
+ */
+bool isFakeWindowMapped(WindowID win);
+/**
+ * @param win
+ * @param mask if not NULL, set to the mask of the last configure request of win
+ *
+ * @return the values of the last configure request of win or NULL
+ */
+const uint32_t* getFakeWindowConfig(WindowID win, uint16_t* mask);
+#endif
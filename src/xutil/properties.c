@@ -24,15 +24,18 @@ void dumpAtoms(const xcb_atom_t* atoms, int numberOfAtoms) {
 xcb_atom_t getAtom(const char* name) {
     if(!name)return XCB_ATOM_NONE;
     xcb_intern_atom_reply_t* reply;
-    reply = xcb_intern_atom_reply(dis, xcb_intern_atom(dis, 0, strlen(name), name), NULL);
+    reply = COUNT_ROUND_TRIP(xcb_intern_atom_reply(dis, xcb_intern_atom(dis, 0, strlen(name), name), NULL));
     xcb_atom_t atom = reply->atom;
     free(reply);
     return atom;
 }
 char* getAtomName(xcb_atom_t atom, char* buffer) {
+    return getAtomNameReply(xcb_get_atom_name(dis, atom), buffer);
+}
+char* getAtomNameReply(xcb_get_atom_name_cookie_t cookie, char* buffer) {
     if(!buffer)
         buffer = __buffer;
-    xcb_get_atom_name_reply_t* valueReply = xcb_get_atom_name_reply(dis, xcb_get_atom_name(dis, atom), NULL);
+    xcb_get_atom_name_reply_t* valueReply = COUNT_ROUND_TRIP(xcb_get_atom_name_reply(dis, cookie, NULL));
     if(valueReply) {
         strncpy(buffer, xcb_get_atom_name_name(valueReply), MIN_NAME_LEN(valueReply->name_len));
         buffer[MIN_NAME_LEN(valueReply->name_len)] = 0;
@@ -45,13 +48,7 @@ char* getAtomName(xcb_atom_t atom, char* buffer) {
 }
 
 xcb_get_property_reply_t* getWindowProperty(WindowID win, xcb_atom_t atom, xcb_atom_t type) {
-    xcb_get_property_reply_t* reply;
-    xcb_get_property_cookie_t cookie = xcb_get_property(dis, 0, win, atom, type, 0, -1);
-    if((reply = xcb_get_property_reply(dis, cookie, NULL)))
-        if(xcb_get_property_value_length(reply))
-            return reply;
-        else free(reply);
-    return NULL;
+    return xBackend->getProperty(win, atom, type);
 }
 int getWindowPropertyValueInt(WindowID win, xcb_atom_t atom, xcb_atom_t type) {
     xcb_get_property_reply_t* reply = getWindowProperty(win, atom, type);
@@ -11,10 +11,12 @@
 void sendButtonPress(int button, MasterID id) {
     XDevice dev = {.device_id = id};
     XTestFakeDeviceButtonEvent(dpy, &dev, button, 1, NULL, 0, CurrentTime);
+    XFlush(dpy);
 }
 void sendButtonRelease(int button, MasterID id) {
     XDevice dev = {.device_id = id};
     XTestFakeDeviceButtonEvent(dpy, &dev, button, 0, NULL, 0, CurrentTime);
+    XFlush(dpy);
 }
 void clickButton(int button, MasterID id) {
     VERBOSE("Clicking button %d for %d", button, id);
@@ -25,10 +27,12 @@ void clickButton(int button, MasterID id) {
 void sendKeyPress(int keyCode, MasterID id) {
     XDevice dev = {.device_id = id};
     XTestFakeDeviceKeyEvent(dpy, &dev, keyCode, 1, NULL, 0, CurrentTime);
+    XFlush(dpy);
 }
 void sendKeyRelease(int keyCode, MasterID id) {
     XDevice dev = {.device_id = id};
     XTestFakeDeviceKeyEvent(dpy, &dev, keyCode, 0, NULL, 0, CurrentTime);
+    XFlush(dpy);
 }
 void typeKey(int keycode, MasterID id) {
     sendKeyPress(keycode, id);
@@ -3,7 +3,9 @@
 #include <xcb/xcb_icccm.h>
 
 #include "window-properties.h"
+#include "x-backend.h"
 #include "xsession.h"
+#include "../util/latency-probe.h"
 #include "../util/logger.h"
 #include "../util/time.h"
 #include "../windows.h"
@@ -27,7 +29,7 @@ void setWindowTypes(WindowID win, xcb_atom_t* atoms, int num) {
 bool getClassInfo(WindowID win, char* className, char* instanceName) {
     xcb_icccm_get_wm_class_reply_t prop;
     xcb_get_property_cookie_t cookie = xcb_icccm_get_wm_class(dis, win);
-    if(xcb_icccm_get_wm_class_reply(dis, cookie, &prop, NULL)) {
+    if(COUNT_ROUND_TRIP(xcb_icccm_get_wm_class_reply(dis, cookie, &prop, NULL))) {
         strcpy(className, prop.class_name);
         strcpy(instanceName, prop.instance_name);
         xcb_icccm_get_wm_class_reply_wipe(&prop);
@@ -38,7 +40,7 @@ bool getClassInfo(WindowID win, char* className, char* instanceName) {
 bool getWindowTitle(WindowID win, char* title) {
     xcb_ewmh_get_utf8_strings_reply_t wtitle;
     xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_name(ewmh, win);
-    if(xcb_ewmh_get_wm_name_reply(ewmh, cookie, &wtitle, NULL)) {
+    if(COUNT_ROUND_TRIP(xcb_ewmh_get_wm_name_reply(ewmh, cookie, &wtitle, NULL))) {
         strncpy(title, wtitle.strings, MIN_NAME_LEN(wtitle.strings_len));
         title[MIN_NAME_LEN(wtitle.strings_len)] = 0;
         xcb_ewmh_get_utf8_strings_reply_wipe(&wtitle);
@@ -47,7 +49,7 @@ bool getWindowTitle(WindowID win, char* title) {
     else {
         xcb_icccm_get_text_property_reply_t icccName;
         cookie = xcb_icccm_get_wm_name(dis, win);
-        if(xcb_icccm_get_wm_name_reply(dis, cookie, &icccName, NULL)) {
+        if(COUNT_ROUND_TRIP(xcb_icccm_get_wm_name_reply(dis, cookie, &icccName, NULL))) {
             strncpy(title, icccName.name, MIN_NAME_LEN(icccName.name_len));
             title[MIN_NAME_LEN(icccName.name_len)] = 0;
             xcb_icccm_get_text_property_reply_wipe(&icccName);
@@ -59,26 +61,116 @@ bool getWindowTitle(WindowID win, char* title) {
 xcb_atom_t getWindowType(WindowID win) {
     xcb_ewmh_get_atoms_reply_t name;
     xcb_atom_t atom = 0;
-    if(xcb_ewmh_get_wm_window_type_reply(ewmh,
-            xcb_ewmh_get_wm_window_type(ewmh, win), &name, NULL)) {
+    if(COUNT_ROUND_TRIP(xcb_ewmh_get_wm_window_type_reply(ewmh,
+            xcb_ewmh_get_wm_window_type(ewmh, win), &name, NULL))) {
         atom = name.atoms[0];
         xcb_ewmh_get_atoms_reply_wipe(&name);
     }
     return atom;
 }
 
-void loadWindowHints(WindowInfo* winInfo) {
-    xcb_icccm_wm_hints_t hints;
-    if(xcb_icccm_get_wm_hints_reply(dis, xcb_icccm_get_wm_hints(dis, winInfo->id), &hints, NULL)) {
-        if(xcb_icccm_wm_hints_get_urgency(&hints)) {
-            addMask(winInfo, URGENT_MASK);
+static uint8_t prefetchedStringProperties;
+void addWindowStringPropertiesPrefetchHint(uint8_t properties) {
+    prefetchedStringProperties |= properties;
+}
+uint8_t getPrefetchedWindowStringProperties(void) {
+    return prefetchedStringProperties;
+}
+void markWindowStringPropertiesStale(WindowInfo* winInfo, uint8_t properties) {
+    winInfo->loadedStringProperties &= ~properties;
+}
+static void loadTitleReply(WindowInfo* winInfo, xcb_get_property_cookie_t ewmhCookie,
+    xcb_get_property_cookie_t icccmCookie) {
+    xcb_ewmh_get_utf8_strings_reply_t wtitle;
+    xcb_icccm_get_text_property_reply_t icccName;
+    winInfo->title[0] = 0;
+    if(COUNT_ROUND_TRIP(xcb_ewmh_get_wm_name_reply(ewmh, ewmhCookie, &wtitle, NULL))) {
+        strncpy(winInfo->title, wtitle.strings, MIN_NAME_LEN(wtitle.strings_len));
+        winInfo->title[MIN_NAME_LEN(wtitle.strings_len)] = 0;
+        xcb_ewmh_get_utf8_strings_reply_wipe(&wtitle);
+        xcb_discard_reply(dis, icccmCookie.sequence);
+    }
+    else if(COUNT_ROUND_TRIP(xcb_icccm_get_wm_name_reply(dis, icccmCookie, &icccName, NULL))) {
+        strncpy(winInfo->title, icccName.name, MIN_NAME_LEN(icccName.name_len));
+        winInfo->title[MIN_NAME_LEN(icccName.name_len)] = 0;
+        xcb_icccm_get_text_property_reply_wipe(&icccName);
+    }
+}
+void loadWindowStringProperties(WindowInfo* winInfo, uint8_t properties) {
+    properties &= ~winInfo->loadedStringProperties;
+    if(!winInfo->type && properties & WINDOW_TYPE_NAME_PROPERTY) {
+        // there is no type to name; the name is marked stale when the type is loaded
+        winInfo->typeName[0] = 0;
+        winInfo->loadedStringProperties |= WINDOW_TYPE_NAME_PROPERTY;
+        properties &= ~WINDOW_TYPE_NAME_PROPERTY;
+    }
+    if(!properties)
+        return;
+    TRACE("Loading string properties %d of window %d", properties, winInfo->id);
+    xcb_get_property_cookie_t classCookie = {0}, titleCookie = {0}, icccmTitleCookie = {0};
+    xcb_get_atom_name_cookie_t typeNameCookie = {0};
+    if(properties & WINDOW_CLASS_PROPERTY)
+        classCookie = xcb_icccm_get_wm_class(dis, winInfo->id);
+    if(properties & WINDOW_TITLE_PROPERTY) {
+        titleCookie = xcb_ewmh_get_wm_name(ewmh, winInfo->id);
+        icccmTitleCookie = xcb_icccm_get_wm_name(dis, winInfo->id);
+    }
+    if(properties & WINDOW_TYPE_NAME_PROPERTY)
+        typeNameCookie = xcb_get_atom_name(dis, winInfo->type);
+
+    if(properties & WINDOW_CLASS_PROPERTY) {
+        xcb_icccm_get_wm_class_reply_t prop;
+        winInfo->className[0] = winInfo->instanceName[0] = 0;
+        if(COUNT_ROUND_TRIP(xcb_icccm_get_wm_class_reply(dis, classCookie, &prop, NULL))) {
+            strncpy(winInfo->className, prop.class_name, MAX_NAME_LEN - 1);
+            strncpy(winInfo->instanceName, prop.instance_name, MAX_NAME_LEN - 1);
+            xcb_icccm_get_wm_class_reply_wipe(&prop);
         }
-        winInfo->groupID = hints.window_group;
-        if(hints.input)
-            addMask(winInfo, INPUT_MASK);
-        else
-            removeMask(winInfo, INPUT_MASK);
     }
+    if(properties & WINDOW_TITLE_PROPERTY)
+        loadTitleReply(winInfo, titleCookie, icccmTitleCookie);
+    if(properties & WINDOW_TYPE_NAME_PROPERTY)
+        getAtomNameReply(typeNameCookie, winInfo->typeName);
+    // goes through the XBackend like all other property reads
+    if(properties & WINDOW_ROLE_PROPERTY)
+        getWindowPropertyString(winInfo->id, WM_WINDOW_ROLE, XCB_ATOM_STRING, winInfo->role);
+    winInfo->loadedStringProperties |= properties;
+}
+const char* getClassName(WindowInfo* winInfo) {
+    loadWindowStringProperties(winInfo, WINDOW_CLASS_PROPERTY);
+    return winInfo->className;
+}
+const char* getInstanceName(WindowInfo* winInfo) {
+    loadWindowStringProperties(winInfo, WINDOW_CLASS_PROPERTY);
+    return winInfo->instanceName;
+}
+const char* getTitle(WindowInfo* winInfo) {
+    loadWindowStringProperties(winInfo, WINDOW_TITLE_PROPERTY);
+    return winInfo->title;
+}
+const char* getRole(WindowInfo* winInfo) {
+    loadWindowStringProperties(winInfo, WINDOW_ROLE_PROPERTY);
+    return winInfo->role;
+}
+const char* getTypeName(WindowInfo* winInfo) {
+    loadWindowStringProperties(winInfo, WINDOW_TYPE_NAME_PROPERTY);
+    return winInfo->typeName;
+}
+
+void setWindowHints(WindowInfo* winInfo, xcb_icccm_wm_hints_t* hints) {
+    if(xcb_icccm_wm_hints_get_urgency(hints)) {
+        addMask(winInfo, URGENT_MASK);
+    }
+    winInfo->groupID = hints->window_group;
+    if(hints->input)
+        addMask(winInfo, INPUT_MASK);
+    else
+        removeMask(winInfo, INPUT_MASK);
+}
+void loadWindowHints(WindowInfo* winInfo) {
+    xcb_icccm_wm_hints_t hints;
+    if(COUNT_ROUND_TRIP(xcb_icccm_get_wm_hints_reply(dis, xcb_icccm_get_wm_hints(dis, winInfo->id), &hints, NULL)))
+        setWindowHints(winInfo, &hints);
 }
 
 
@@ -154,6 +246,7 @@ int focusWindowAsMaster(WindowID win, Master* master) {
     DEBUG("Trying to set focus to %d for master %d", win, master->id);
     assert(win);
     xcb_void_cookie_t cookie = xcb_input_xi_set_focus_checked(dis, win, XCB_CURRENT_TIME, getKeyboardID(master));
+    markLatencyProbeRequest();
     return !catchError(cookie);
 }
 int focusWindowInfoAsMaster(WindowInfo* winInfo, Master* master) {
@@ -168,8 +261,8 @@ int focusWindowInfoAsMaster(WindowInfo* winInfo, Master* master) {
 
 uint32_t getUserTime(WindowID win) {
     uint32_t timestamp = 1;
-    xcb_ewmh_get_wm_user_time_window_reply(ewmh, xcb_ewmh_get_wm_user_time_window(ewmh, win), &win, NULL);
-    xcb_ewmh_get_wm_user_time_reply(ewmh, xcb_ewmh_get_wm_user_time(ewmh, win), &timestamp, NULL);
+    COUNT_ROUND_TRIP(xcb_ewmh_get_wm_user_time_window_reply(ewmh, xcb_ewmh_get_wm_user_time_window(ewmh, win), &win, NULL));
+    COUNT_ROUND_TRIP(xcb_ewmh_get_wm_user_time_reply(ewmh, xcb_ewmh_get_wm_user_time(ewmh, win), &timestamp, NULL));
     return timestamp;
 }
 
@@ -192,25 +285,25 @@ WindowID createWindow(WindowID parent, xcb_window_class_t clazz, uint32_t mask,
 void destroyWindowInfo(WindowInfo* winInfo) {
     destroyWindow(winInfo->id);
 }
-int destroyWindow(WindowID win) {
+void destroyWindow(WindowID win) {
     assert(win);
     DEBUG("Destroying window %d", win);
-    return catchError(xcb_destroy_window_checked(dis, win));
+    XCALL(xcb_destroy_window, dis, win);
 }
 WindowID mapWindow(WindowID id) {
     TRACE("Mapping %d", id);
-    xcb_map_window(dis, id);
+    xBackend->mapWindow(id);
     return id;
 }
 void unmapWindow(WindowID id) {
     TRACE("UnMapping %d", id);
-    xcb_unmap_window(dis, id);
+    xBackend->unmapWindow(id);
 }
 
-int killClientOfWindow(WindowID win) {
+void killClientOfWindow(WindowID win) {
     assert(win);
     DEBUG("Killing window %d", win);
-    return catchError(xcb_kill_client_checked(dis, win));
+    XCALL(xcb_kill_client, dis, win);
 }
 void killClientOfWindowInfo(WindowInfo* winInfo) {
     killClientOfWindow(winInfo->id);
@@ -218,7 +311,7 @@ void killClientOfWindowInfo(WindowInfo* winInfo) {
 
 Rect getRealGeometry(WindowID id) {
     Rect rect = {0};
-    xcb_get_geometry_reply_t* reply = xcb_get_geometry_reply(dis, xcb_get_geometry(dis, id), NULL);
+    xcb_get_geometry_reply_t* reply = COUNT_ROUND_TRIP(xcb_get_geometry_reply(dis, xcb_get_geometry(dis, id), NULL));
     if(reply) {
         rect = *(Rect*)&reply->x;
         free(reply);
@@ -227,7 +320,7 @@ Rect getRealGeometry(WindowID id) {
 }
 uint16_t getWindowBorder(WindowID id) {
     int border = 0;
-    xcb_get_geometry_reply_t* reply = xcb_get_geometry_reply(dis, xcb_get_geometry(dis, id), NULL);
+    xcb_get_geometry_reply_t* reply = COUNT_ROUND_TRIP(xcb_get_geometry_reply(dis, xcb_get_geometry(dis, id), NULL));
     if(reply) {
         border = reply->border_width;
         free(reply);
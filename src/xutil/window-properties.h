@@ -71,6 +71,60 @@ bool getClassInfo(WindowID win, char* className, char* instanceName);
 bool getWindowTitle(WindowID win, char* title);
 
 xcb_atom_t getWindowType(WindowID win);
+
+/**
+ * Loads the requested string properties of winInfo that haven't already been loaded.
+ * The requests for all the properties are sent before waiting on any reply.
+ *
+ * @param winInfo
+ * @param properties bitmask of WindowStringProperty
+ */
+void loadWindowStringProperties(WindowInfo* winInfo, uint8_t properties);
+/**
+ * Marks properties as out of date so they will be reloaded the next time they are accessed
+ *
+ * @param winInfo
+ * @param properties bitmask of WindowStringProperty
+ */
+void markWindowStringPropertiesStale(WindowInfo* winInfo, uint8_t properties);
+/**
+ * Properties that will be loaded as soon as a window is allowed to map instead of on first access.
+ * Rules that are known to read the string properties of most windows should add them here so that they can be
+ * fetched together.
+ *
+ * @param properties bitmask of WindowStringProperty
+ */
+void addWindowStringPropertiesPrefetchHint(uint8_t properties);
+/**
+ * @return bitmask of WindowStringProperty that will be eagerly loaded
+ * @see addWindowStringPropertiesPrefetchHint
+ */
+uint8_t getPrefetchedWindowStringProperties(void);
+/**
+ * @param winInfo
+ * @return the class name of winInfo; loaded if needed
+ */
+const char* getClassName(WindowInfo* winInfo);
+/**
+ * @param winInfo
+ * @return the instance name of winInfo; loaded if needed
+ */
+const char* getInstanceName(WindowInfo* winInfo);
+/**
+ * @param winInfo
+ * @return the title of winInfo; loaded if needed
+ */
+const char* getTitle(WindowInfo* winInfo);
+/**
+ * @param winInfo
+ * @return the role of winInfo; loaded if needed
+ */
+const char* getRole(WindowInfo* winInfo);
+/**
+ * @param winInfo
+ * @return the name of the type of winInfo; loaded if needed
+ */
+const char* getTypeName(WindowInfo* winInfo);
 /**
  * Sets WM_WINDOW_ROLE to role on wid
  *
@@ -138,6 +192,13 @@ xcb_size_hints_t* getWindowSizeHints(WindowInfo* winInfo);
  * @see loadWindowProperties
  */
 void loadWindowHints(WindowInfo* winInfo);
+/**
+ * Sets the groupID, input and urgency of winInfo from already loaded hints
+ * @param winInfo
+ * @param hints
+ * @see loadWindowHints
+ */
+void setWindowHints(WindowInfo* winInfo, xcb_icccm_wm_hints_t* hints);
 
 /**
  * @param id
@@ -164,10 +225,11 @@ void setUserTime(WindowID win, uint32_t time);
 
 /**
  * Send a kill signal to the client with the window
+ *
+ * Errors are reported asynchronously; @see trackRequest
  * @param win
- * @return 0 on success or the error
  */
-int killClientOfWindow(WindowID win);
+void killClientOfWindow(WindowID win);
 
 /**
  * Sends a WM_DELETE_WINDOW message or sends a kill requests
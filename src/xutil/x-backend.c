@@ -0,0 +1,100 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include <xcb/xinput.h>
+
+#include "../util/logger.h"
+#include "device-grab.h"
+#include "x-backend.h"
+#include "xsession.h"
+
+#pragma GCC diagnostic ignored "-Wnarrowing"
+
+static void xcbConfigureWindow(WindowID win, uint16_t mask, const uint32_t* values) {
+    XCALL(xcb_configure_window, dis, win, mask, values);
+}
+static void xcbMapWindow(WindowID win) {
+    XCALL(xcb_map_window, dis, win);
+}
+static void xcbUnmapWindow(WindowID win) {
+    XCALL(xcb_unmap_window, dis, win);
+}
+static void xcbChangeProperty(WindowID win, xcb_atom_t atom, xcb_atom_t type, uint8_t format, uint32_t len,
+    const void* data) {
+    XCALL(xcb_change_property, dis, XCB_PROP_MODE_REPLACE, win, atom, type, format, len, data);
+}
+static void xcbDeleteProperty(WindowID win, xcb_atom_t atom) {
+    XCALL(xcb_delete_property, dis, win, atom);
+}
+static xcb_get_property_reply_t* xcbGetProperty(WindowID win, xcb_atom_t atom, xcb_atom_t type) {
+    xcb_get_property_reply_t* reply;
+    xcb_get_property_cookie_t cookie = xcb_get_property(dis, 0, win, atom, type, 0, -1);
+    if((reply = COUNT_ROUND_TRIP(xcb_get_property_reply(dis, cookie, NULL))))
+        if(xcb_get_property_value_length(reply))
+            return reply;
+        else free(reply);
+    return NULL;
+}
+/**
+ * Frees and logs error if set
+ *
+ * @return 1 iff there was an error
+ */
+static bool checkReplyError(xcb_generic_error_t* error) {
+    if(error) {
+        logError(error);
+        free(error);
+        return 1;
+    }
+    return 0;
+}
+static int xcbGrabDevice(MasterID deviceID, uint32_t maskValue) {
+    xcb_generic_error_t* error = NULL;
+    xcb_input_xi_grab_device_reply_t* reply = COUNT_ROUND_TRIP(xcb_input_xi_grab_device_reply(dis,
+            xcb_input_xi_grab_device(dis, root, XCB_CURRENT_TIME, XCB_NONE, deviceID, XCB_INPUT_GRAB_MODE_22_ASYNC,
+                XCB_INPUT_GRAB_MODE_22_ASYNC, 1, 1, &maskValue), &error));
+    int status = checkReplyError(error) || !reply ? -1 : reply->status;
+    free(reply);
+    return status;
+}
+static int xcbUngrabDevice(MasterID id) {
+    XCALL(xcb_input_xi_ungrab_device, dis, XCB_CURRENT_TIME, id);
+    return 0;
+}
+static int xcbGrabDetail(MasterID deviceID, uint32_t detail, uint32_t mod, uint32_t maskValue, uint32_t ignoreMod) {
+    uint32_t modifiers[4] = {mod, mod | IGNORE_MASK, mod | ignoreMod, mod | IGNORE_MASK | ignoreMod};
+    int size = ignoreMod ? LEN(modifiers) : LEN(modifiers) / 2;
+    bool isKeyboard = getKeyboardMask(maskValue);
+    uint8_t grabMode = isKeyboard || maskValue & XCB_INPUT_XI_EVENT_MASK_BUTTON_RELEASE ?
+        XCB_INPUT_GRAB_MODE_22_ASYNC : XCB_INPUT_GRAB_MODE_22_SYNC;
+    xcb_generic_error_t* error = NULL;
+    xcb_input_xi_passive_grab_device_reply_t* reply = COUNT_ROUND_TRIP(xcb_input_xi_passive_grab_device_reply(dis,
+            xcb_input_xi_passive_grab_device(dis, XCB_CURRENT_TIME, root, XCB_NONE, detail, deviceID, size, 1,
+                isKeyboard ? XCB_INPUT_GRAB_TYPE_KEYCODE : XCB_INPUT_GRAB_TYPE_BUTTON, grabMode,
+                XCB_INPUT_GRAB_MODE_22_ASYNC, 1, &maskValue, modifiers), &error));
+    // the reply lists the modifiers that couldn't be grabbed
+    int failed = checkReplyError(error) || !reply ? size : reply->num_modifiers;
+    free(reply);
+    return failed;
+}
+static int xcbUngrabDetail(MasterID deviceID, uint32_t detail, uint32_t mod, uint32_t ignoreMod, bool isKeyboard) {
+    uint32_t modifiers[4] = {mod, mod | IGNORE_MASK, mod | ignoreMod, mod | IGNORE_MASK | ignoreMod};
+    int size = ignoreMod ? LEN(modifiers) : LEN(modifiers) / 2;
+    XCALL(xcb_input_xi_passive_ungrab_device, dis, root, detail, deviceID, size,
+        isKeyboard ? XCB_INPUT_GRAB_TYPE_KEYCODE : XCB_INPUT_GRAB_TYPE_BUTTON, modifiers);
+    return 0;
+}
+
+const XBackend xcbBackend = {
+    .configureWindow = xcbConfigureWindow,
+    .mapWindow = xcbMapWindow,
+    .unmapWindow = xcbUnmapWindow,
+    .changeProperty = xcbChangeProperty,
+    .deleteProperty = xcbDeleteProperty,
+    .getProperty = xcbGetProperty,
+    .grabDevice = xcbGrabDevice,
+    .ungrabDevice = xcbUngrabDevice,
+    .grabDetail = xcbGrabDetail,
+    .ungrabDetail = xcbUngrabDetail,
+};
+const XBackend* xBackend = &xcbBackend;
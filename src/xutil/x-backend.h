@@ -0,0 +1,70 @@
+/**
+ * @file x-backend.h
+ * @brief Seam through which window configuration, mapping, properties and grabs reach the X server
+ *
+ * By default requests are sent to the X server with xcb/XI. Swapping in another backend (ie fakeXBackend) lets
+ * core logic run without a display.
+ */
+#ifndef MPX_X_BACKEND_H_
+#define MPX_X_BACKEND_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <xcb/xcb.h>
+#include "../mywm-structs.h"
+
+/// The types of requests that go through an XBackend
+typedef enum {
+    X_CONFIGURE_WINDOW,
+    X_MAP_WINDOW,
+    X_UNMAP_WINDOW,
+    X_CHANGE_PROPERTY,
+    X_DELETE_PROPERTY,
+    X_GET_PROPERTY,
+    X_GRAB_DEVICE,
+    X_UNGRAB_DEVICE,
+    X_GRAB_DETAIL,
+    X_UNGRAB_DETAIL,
+    /// number of request types
+    NUMBER_OF_X_BACKEND_REQUESTS
+} XBackendRequest;
+
+/// Implementations of the requests that can be routed away from the X server
+typedef struct XBackend {
+    /// @see configureWindow
+    void (*configureWindow)(WindowID win, uint16_t mask, const uint32_t* values);
+    /// @see mapWindow
+    void (*mapWindow)(WindowID win);
+    /// @see unmapWindow
+    void (*unmapWindow)(WindowID win);
+    /// replaces the property atom of win with len elements of data, each of size format bits
+    void (*changeProperty)(WindowID win, xcb_atom_t atom, xcb_atom_t type, uint8_t format, uint32_t len,
+        const void* data);
+    /// @see clearWindowProperty
+    void (*deleteProperty)(WindowID win, xcb_atom_t atom);
+    /// @see getWindowProperty
+    xcb_get_property_reply_t* (*getProperty)(WindowID win, xcb_atom_t atom, xcb_atom_t type);
+    /// @see grabDevice
+    int (*grabDevice)(MasterID deviceID, uint32_t maskValue);
+    /// @see ungrabDevice
+    int (*ungrabDevice)(MasterID deviceID);
+    /// @see grabDetail
+    int (*grabDetail)(MasterID deviceID, uint32_t detail, uint32_t mod, uint32_t maskValue, uint32_t ignoreMod);
+    /// @see ungrabDetail
+    int (*ungrabDetail)(MasterID deviceID, uint32_t detail, uint32_t mod, uint32_t ignoreMod, bool isKeyboard);
+} XBackend;
+
+/// Sends requests to the X server
+extern const XBackend xcbBackend;
+/// The backend all requests are routed through; defaults to xcbBackend
+extern const XBackend* xBackend;
+
+/**
+ * Routes all future requests through backend
+ *
+ * @param backend
+ */
+static inline void setXBackend(const XBackend* backend) {
+    xBackend = backend;
+}
+#endif
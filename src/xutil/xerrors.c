@@ -29,7 +29,7 @@ const char* opcodeToString(int opcode) {
 }
 
 int catchError(xcb_void_cookie_t cookie) {
-    xcb_generic_error_t* e = xcb_request_check(dis, cookie);
+    xcb_generic_error_t* e = COUNT_ROUND_TRIP(xcb_request_check(dis, cookie));
     int errorCode = 0;
     if(e) {
         errorCode = e->error_code;
@@ -39,7 +39,7 @@ int catchError(xcb_void_cookie_t cookie) {
     return errorCode;
 }
 int catchErrorSilent(xcb_void_cookie_t cookie) {
-    xcb_generic_error_t* e = xcb_request_check(dis, cookie);
+    xcb_generic_error_t* e = COUNT_ROUND_TRIP(xcb_request_check(dis, cookie));
     int errorCode = 0;
     if(e) {
         errorCode = e->error_code;
@@ -47,9 +47,40 @@ int catchErrorSilent(xcb_void_cookie_t cookie) {
     }
     return errorCode;
 }
+/// A request whose errors should be attributed to where it was sent from
+typedef struct {
+    uint32_t sequence;
+    const char* callSite;
+    XRequestErrorHandler handler;
+} TrackedRequest;
+/// indexed by sequence number; since errors arrive in order, only recent requests need to be remembered
+static TrackedRequest trackedRequests[TRACKED_REQUESTS_SIZE];
+
+void trackRequest(xcb_void_cookie_t cookie, const char* callSite, XRequestErrorHandler handler) {
+    trackedRequests[cookie.sequence % TRACKED_REQUESTS_SIZE] = (TrackedRequest) {cookie.sequence, callSite, handler};
+}
+static TrackedRequest* getTrackedRequest(const xcb_generic_error_t* e) {
+    TrackedRequest* request = &trackedRequests[e->sequence % TRACKED_REQUESTS_SIZE];
+    // compare against the sequence number xcb widened so a request tracked 65536 requests ago doesn't match
+    return request->callSite && request->sequence == e->full_sequence ? request : NULL;
+}
+const char* getCallSiteOfError(const xcb_generic_error_t* e) {
+    TrackedRequest* request = getTrackedRequest(e);
+    return request ? request->callSite : NULL;
+}
+void handleXError(xcb_generic_error_t* e) {
+    TrackedRequest* request = getTrackedRequest(e);
+    if(request && request->handler)
+        request->handler(e);
+    else
+        logError(e);
+}
 void logError(xcb_generic_error_t* e) {
     ERROR("error occurred with seq %d resource %d. Error code: %d %s (%d %d)", e->sequence, e->resource_id, e->error_code,
         opcodeToString(e->major_code), e->major_code, e->minor_code);
+    const char* callSite = getCallSiteOfError(e);
+    if(callSite)
+        ERROR("Request was sent from %s", callSite);
     int size = 256;
     char buff[size];
     XGetErrorText(dpy, e->error_code, buff, size);
@@ -4,6 +4,7 @@
 
 #include <xcb/xcb.h>
 #include <xcb/xcb_ewmh.h>
+#include <xcb/xinput.h>
 #include <X11/Xlib-xcb.h>
 
 #include "../globals.h"
@@ -135,9 +136,12 @@ void openXDisplay(void) {
     assert(!xcb_connection_has_error(dis));
     xcb_intern_atom_cookie_t* cookie;
     bool applyRule = ewmh == NULL;
+    // XI2 requests are only valid once the client has announced which version it supports
+    xcb_input_xi_query_version_cookie_t versionCookie = xcb_input_xi_query_version(dis, 2, 2);
     ewmh = (xcb_ewmh_connection_t*)malloc(sizeof(xcb_ewmh_connection_t));
     cookie = xcb_ewmh_init_atoms(dis, ewmh);
     xcb_ewmh_init_atoms_replies(ewmh, cookie, NULL);
+    free(xcb_input_xi_query_version_reply(dis, versionCookie, NULL));
     CREATE_ATOM(MPX_IDLE_PROPERTY);
     CREATE_ATOM(MPX_RESTART_COUNTER);
     CREATE_ATOM(MPX_WM_INTERPROCESS_COM);
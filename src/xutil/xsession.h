@@ -15,6 +15,9 @@
 #include "../window-masks.h"
 #include "../util/rect.h"
 #include "../globals.h"
+#include "../util/latency-probe.h"
+#include "../util/request-stats.h"
+#include "x-backend.h"
 
 /**
  * The max number of devices the XServer can support.
@@ -125,11 +128,11 @@ void closeConnection(void);
 /**
  * Flush the X connection
  *
- * This method is just a wrapper for XFlush and xcb_flush
+ * All requests go through xcb; the only Xlib requests (XTest in test-functions.c) flush themselves
  */
 static inline void flush(void) {
     xcb_flush(dis);
-    XFlush(dpy);
+    onLatencyProbeFlush();
 }
 
 /**
@@ -151,6 +154,15 @@ xcb_atom_t getAtom(const char* name);
  * @return the name of the atom
  */
 char* getAtomName(xcb_atom_t atom, char* buffer);
+/**
+ * Like getAtomName but reads the reply of an already sent request.
+ * Allows the names of multiple atoms to be requested before waiting on any reply
+ *
+ * @param cookie the cookie returned from xcb_get_atom_name
+ * @param buffer where to store the name or NULL to use a shared static buffer
+ * @return the name of the atom or "" if it could not be retrieved
+ */
+char* getAtomNameReply(xcb_get_atom_name_cookie_t cookie, char* buffer);
 
 /**
  *
@@ -208,6 +220,32 @@ int catchError(xcb_void_cookie_t cookie);
  * @param e
  */
 void logError(xcb_generic_error_t* e);
+/// Called instead of logError when a request tracked with trackRequest fails
+typedef void (*XRequestErrorHandler)(xcb_generic_error_t* e);
+/// Number of outstanding requests that can be tracked at once; older entries are overwritten
+#define TRACKED_REQUESTS_SIZE 1024
+/**
+ * Remembers where the request of cookie was sent from without waiting on the X server.
+ * If the request fails, the error will be delivered asynchronously with the other events and
+ * handleXError will attribute it back to callSite and handler.
+ *
+ * @param cookie the result of a non-checked xcb function
+ * @param callSite a static string describing where the request was sent
+ * @param handler if non-null, called instead of logError if the request fails
+ */
+void trackRequest(xcb_void_cookie_t cookie, const char* callSite, XRequestErrorHandler handler);
+/**
+ * @param e
+ *
+ * @return the callSite the request that caused e was tracked with or NULL
+ */
+const char* getCallSiteOfError(const xcb_generic_error_t* e);
+/**
+ * Passes e to the handler of the tracked request that caused it or logs it
+ *
+ * @param e an asynchronous error from the event queue
+ */
+void handleXError(xcb_generic_error_t* e);
 /**
  * Stringifies opcode
  * @param opcode a major code from a xcb_generic_error_t object
@@ -275,11 +313,11 @@ void unmapWindow(WindowID id);
  * Destroys win but not the underlying client.
  * The underlying client may choose to die if win is closed.
  *
- * @param win
+ * Errors are reported asynchronously; @see trackRequest
  *
- * @return 0 on success or the error
+ * @param win
  */
-int destroyWindow(WindowID win);
+void destroyWindow(WindowID win);
 
 void destroyWindowInfo(WindowInfo* winInfo);
 
@@ -323,11 +361,11 @@ int getWindowPropertyValueInt(WindowID win, xcb_atom_t atom, xcb_atom_t type);
 char* getWindowPropertyString(WindowID win, xcb_atom_t atom, xcb_atom_t type, char* result);
 bool getWindowPropertyStrings(WindowID win, xcb_atom_t atom, xcb_atom_t type, char** str, int N);
 
-/// When NDEBUG is set XCALL will call the checked version of X and check for errors
+/// When NDEBUG isn't set XCALL will track the request so errors can be attributed to the caller
 #ifndef NDEBUG
-#define XCALL(X, args...) catchError(_CAT(X,_checked)(args))
+#define XCALL(X, args...) (countXRequest(), trackRequest(X(args), __FILE__ ":" _STR(__LINE__) " " #X, NULL))
 #else
-#define XCALL(X, args...) X(args)
+#define XCALL(X, args...) (countXRequest(), X(args))
 #endif
 /**
  *
@@ -341,7 +379,7 @@ bool getWindowPropertyStrings(WindowID win, xcb_atom_t atom, xcb_atom_t type, ch
  * @param len the number of members of arr
  */
 #define setWindowProperty(win, atom, type, arr, len) \
-    XCALL(xcb_change_property, dis, XCB_PROP_MODE_REPLACE, win, atom, type, sizeof((arr)[0]) * 8, len, arr);
+    xBackend->changeProperty(win, atom, type, sizeof((arr)[0]) * 8, len, arr);
 
 /// @{
 /**
@@ -372,7 +410,7 @@ static inline void setWindowPropertyStrings(WindowID win, xcb_atom_t atom, xcb_a
  * @param atom
  */
 static inline void clearWindowProperty(WindowID win, xcb_atom_t atom) {
-    XCALL(xcb_delete_property, dis, win, atom);
+    xBackend->deleteProperty(win, atom);
 }
 
 void dumpAtoms(const xcb_atom_t* atoms, int numberOfAtoms);